@@ -44,7 +44,8 @@ public class AnimCurveTool : ModuleRules
 				"SlateCore",
 				"PropertyEditor",
 				"ContentBrowser",
-				"AnimationModifiers"
+				"AnimationModifiers",
+				"AnimCurveToolRuntime"
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
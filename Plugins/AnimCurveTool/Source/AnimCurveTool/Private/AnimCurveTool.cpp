@@ -8,6 +8,13 @@
 
 #include "AnimCurveToolStyle.h"
 #include "AnimCurveToolCommands.h"
+#include "AnimCurveToolSync.h"
+#include "AnimCurveToolGaitCurves.h"
+#include "AnimCurveToolDistanceCurve.h"
+#include "AnimCurveToolContactDetector.h"
+#include "AnimCurveToolScheduler.h"
+#include "AnimCurveToolTrajectoryCache.h"
+#include "GaitTableUserData.h"
 #include "IMessageTracer.h"
 #include "LevelEditor.h"
 #include "Widgets/Docking/SDockTab.h"
@@ -16,6 +23,10 @@
 #include "ToolMenus.h"
 #include "Animation/AnimNodeBase.h"
 #include "Components/SplineComponent.h"
+#include "Async/ParallelFor.h"
+#include "Misc/MemStack.h"
+#include "Async/Async.h"
+#include "FileHelpers.h"
 
 static const FName AnimCurveToolTabName("AnimTool");
 
@@ -26,18 +37,135 @@ SGMarkerReference::SGMarkerReference(UAnimSequence * Anim, FName LeftFoot, FName
 	AnimSequence = Anim;
 	bIsValid = false;
 	Dir = GetAnimDirection();
+	AnalysisTime = FDateTime::Now();
+
+	FFootTrajectory Trajectory;
+	if (!Trajectory.Sample(Anim, { LeftFoot, RightFoot }))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Failed to sample foot trajectory for %s"), *Anim->GetName());
+		return;
+	}
+	Initialize(LeftFoot, RightFoot, Trajectory, *IContactDetector::GetDetectors()[0], FContactDetectorSettings());
+}
+
+SGMarkerReference::SGMarkerReference(UAnimSequence * Anim, FName LeftFoot, FName RightFoot, const FFootTrajectory& Trajectory, const IContactDetector& Detector, const FContactDetectorSettings& Settings)
+{
+	AnimSequence = Anim;
+	bIsValid = false;
+	Dir = GetAnimDirection();
+	AnalysisTime = FDateTime::Now();
+	Initialize(LeftFoot, RightFoot, Trajectory, Detector, Settings);
+}
+
+SGMarkerReference::SGMarkerReference(UAnimSequence * Anim, const FGaitCacheEntryView& CacheView)
+{
+	const FGaitCacheIndexEntry & Entry = *CacheView.Entry;
+	AnimSequence = Anim;
+	Tolerance = Entry.Tolerance;
+	Dir = (Direction)Entry.Dir;
+	bIsValid = Entry.bIsValid != 0;
+	bUsedFallback = Entry.bUsedFallback != 0;
+	DetectorName = CacheView.GetDetectorName();
+	AnalysisTime = FDateTime(Entry.AnalysisTicks);
+	CacheDataHash = Entry.DataHash;
+	CacheSettingsHash = Entry.SettingsHash;
+
+	LeftMarkers.Append(CacheView.LeftMarkers.GetData(), CacheView.LeftMarkers.Num());
+	RightMarkers.Append(CacheView.RightMarkers.GetData(), CacheView.RightMarkers.Num());
+	LeftLiftOffs.Append(CacheView.LeftLiftOffs.GetData(), CacheView.LeftLiftOffs.Num());
+	RightLiftOffs.Append(CacheView.RightLiftOffs.GetData(), CacheView.RightLiftOffs.Num());
+	Intervals.Reserve(CacheView.Intervals.Num());
+	for (const FGaitCacheInterval & Interval : CacheView.Intervals)
+	{
+		FootInterval & Restored = Intervals.Add_GetRef(FootInterval(Interval.Left, Interval.Right, Interval.bOrderIsLeftRight != 0));
+		Restored.IsWrapped = Interval.bIsWrapped != 0;
+	}
+}
+
+SGMarkerReference::SGMarkerReference(UAnimSequence * Anim, const SGMarkerReference& MirrorSource)
+{
+	AnimSequence = Anim;
+	bIsValid = false;
+	Dir = GetAnimDirection();
+	AnalysisTime = FDateTime::Now();
+	Tolerance = MirrorSource.Tolerance;
+	DetectorName = MirrorSource.DetectorName;
+	bUsedFallback = MirrorSource.bUsedFallback;
+	bFallbackFromDeadline = MirrorSource.bFallbackFromDeadline;
+	bFromMirror = true;
+
+	// 镜像动画中左脚的动作即原动画中右脚的动作
+	LeftMarkers = MirrorSource.RightMarkers;
+	RightMarkers = MirrorSource.LeftMarkers;
+	LeftLiftOffs = MirrorSource.RightLiftOffs;
+	RightLiftOffs = MirrorSource.LeftLiftOffs;
+
+	BuildIntervals();
+}
+
+void SGMarkerReference::Initialize(FName LeftFoot, FName RightFoot, const FFootTrajectory& Trajectory, const IContactDetector& Detector, const FContactDetectorSettings& Settings)
+{
+	DetectorName = Detector.GetName();
+
+	const int32 LeftIndex = Trajectory.GetFootIndex(LeftFoot);
+	const int32 RightIndex = Trajectory.GetFootIndex(RightFoot);
+	if (LeftIndex == INDEX_NONE || RightIndex == INDEX_NONE)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Foot bones are missing from the sampled trajectory of %s"), *AnimSequence->GetName());
+		return;
+	}
+
+	// 方向标签由动画名称决定，检测器共用同一份轨迹，时间预算对整个动画计算
+	FContactDetectorSettings DetectorSettings = Settings;
+	DetectorSettings.Dir = Dir;
+	DetectorSettings.Deadline = Settings.TimeBudget > 0.f ? FPlatformTime::Seconds() + Settings.TimeBudget : 0.0;
 
 	// 计算各个动画的步态基准点
-	LeftMarkers = GetContactTimeFromTurning(AnimSequence, LeftFoot);
+	FContactDetection Left, Right;
+	Detector.Detect(Trajectory, LeftIndex, DetectorSettings, Left);
+	if (!Left.bAborted)
+	{
+		Detector.Detect(Trajectory, RightIndex, DetectorSettings, Right);
+	}
+
+	// 超出限制时改用后备检测器，两只脚需要使用同一个检测器
+	if (Left.bAborted || Right.bAborted)
+	{
+		const IContactDetector * Fallback = IContactDetector::FindDetector(Settings.FallbackDetectorName);
+		if (Fallback == nullptr || Fallback == &Detector)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Contact detection for %s exceeded its limits and no fallback is available."), *AnimSequence->GetName());
+			return;
+		}
+
+		UE_LOG(LogTemp, Warning, TEXT("Contact detection for %s exceeded its limits, falling back to %s."), *AnimSequence->GetName(), *Fallback->GetName().ToString());
+		bFallbackFromDeadline = DetectorSettings.IsOverBudget();
+		DetectorSettings.Deadline = 0.0;
+		Fallback->Detect(Trajectory, LeftIndex, DetectorSettings, Left);
+		Fallback->Detect(Trajectory, RightIndex, DetectorSettings, Right);
+		DetectorName = Fallback->GetName();
+		bUsedFallback = true;
+	}
+
+	LeftMarkers = MoveTemp(Left.Contacts);
 	LeftMarkers.Sort();
+	LeftLiftOffs = MoveTemp(Left.LiftOffs);
+	LeftLiftOffs.Sort();
 
-	RightMarkers = GetContactTimeFromTurning(AnimSequence, RightFoot);
+	RightMarkers = MoveTemp(Right.Contacts);
 	RightMarkers.Sort();
+	RightLiftOffs = MoveTemp(Right.LiftOffs);
+	RightLiftOffs.Sort();
+
+	BuildIntervals();
+}
 
+void SGMarkerReference::BuildIntervals()
+{
 	// 基准点不合法的情况
 	if (LeftMarkers.Num() == 0 || RightMarkers.Num() == 0 || LeftMarkers.Num() != RightMarkers.Num())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Reference group calculation failed for %s: left: %d, right: %d"), *Anim->GetName(), LeftMarkers.Num(), RightMarkers.Num());
+		UE_LOG(LogTemp, Warning, TEXT("Reference group calculation failed for %s: left: %d, right: %d"), *AnimSequence->GetName(), LeftMarkers.Num(), RightMarkers.Num());
 		return;
 	}
 	
@@ -79,48 +207,96 @@ SGMarkerReference::SGMarkerReference(UAnimSequence * Anim, FName LeftFoot, FName
 
 Direction SGMarkerReference::GetAnimDirection()
 {
-	const FString AnimName = AnimSequence->GetName();
+	Direction Result = Direction::f;
+	if (!GetDirectionFromName(AnimSequence->GetName(), Result))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("No Direction Assigned for %s. Check Naming Convention."), *AnimSequence->GetName());
+	}
+	return Result;
+}
 
+bool SGMarkerReference::GetDirectionFromName(const FString& AnimName, Direction& OutDir)
+{
 	// 根据动画名称进行标签
 	if (AnimName.EndsWith(FString("FL")))
 	{
-		return Direction::lf;
+		OutDir = Direction::lf;
 	}
 	else if (AnimName.EndsWith(FString("FR")))
 	{
-		return Direction::rf;
+		OutDir = Direction::rf;
 	}
 	else if (AnimName.EndsWith(FString("BL")))
 	{
-		return Direction::lb;
+		OutDir = Direction::lb;
 	}
 	else if (AnimName.EndsWith(FString("BR")))
 	{
-		return Direction::rb;
+		OutDir = Direction::rb;
 	}
-	
-	if (AnimName.EndsWith(FString("F")))
+	else if (AnimName.EndsWith(FString("F")))
 	{
-		return Direction::f;
+		OutDir = Direction::f;
 	}
 	else if (AnimName.EndsWith(FString("B")))
 	{
-		return Direction::b;
+		OutDir = Direction::b;
 	}
 	else if (AnimName.EndsWith(FString("R")))
 	{
-		return Direction::r;
+		OutDir = Direction::r;
 	}
 	else if (AnimName.EndsWith(FString("L")))
 	{
-		return Direction::l;
+		OutDir = Direction::l;
+	}
+	else
+	{
+		OutDir = Direction::f;
+		return false;
+	}
+	return true;
+}
+
+bool SGMarkerReference::GetMirrorName(const FString& AnimName, FString& OutMirrorName)
+{
+	Direction Dir;
+	if (!GetDirectionFromName(AnimName, Dir) || Dir == Direction::f || Dir == Direction::b)
+	{
+		return false;
+	}
+
+	// 左右方向的后缀都以L或R结尾，互换最后一个字符，保留大小写
+	OutMirrorName = AnimName;
+	TCHAR & Last = OutMirrorName[OutMirrorName.Len() - 1];
+	switch (Last)
+	{
+	case TEXT('L'): Last = TEXT('R'); break;
+	case TEXT('R'): Last = TEXT('L'); break;
+	case TEXT('l'): Last = TEXT('r'); break;
+	case TEXT('r'): Last = TEXT('l'); break;
+	default: return false;
 	}
+	return true;
+}
 
-	UE_LOG(LogTemp, Warning, TEXT("No Direction Assigned for %s. Check Naming Convention."), *AnimSequence->GetName());
-	return Direction::f;
+FString SGMarkerReference::GetDirectionName(Direction Dir)
+{
+	switch (Dir)
+	{
+	case Direction::l: return FString("L");
+	case Direction::r: return FString("R");
+	case Direction::f: return FString("F");
+	case Direction::b: return FString("B");
+	case Direction::lf: return FString("FL");
+	case Direction::rf: return FString("FR");
+	case Direction::lb: return FString("BL");
+	case Direction::rb: return FString("BR");
+	default: return FString("?");
+	}
 }
 
-bool SGMarkerReference::GetRatioFromTime(float Time, float & RefRatio, bool & IsOrderLeftRight)
+bool SGMarkerReference::GetRatioFromTime(float Time, float & RefRatio, bool & IsOrderLeftRight) const
 {
 	FootInterval target = Intervals[Intervals.Num()-1];
 
@@ -150,7 +326,7 @@ bool SGMarkerReference::GetRatioFromTime(float Time, float & RefRatio, bool & Is
 	return true;	
 }
 
-bool SGMarkerReference::GetTimeFromRatio(float RefRatio, bool IsOrderLeftRight, TArray<float> & Time)
+bool SGMarkerReference::GetTimeFromRatio(float RefRatio, bool IsOrderLeftRight, TArray<float> & Time) const
 {
 	Time.Reset();
 	const float Len = AnimSequence->GetPlayLength();
@@ -174,84 +350,6 @@ bool SGMarkerReference::GetTimeFromRatio(float RefRatio, bool IsOrderLeftRight,
 	return true;
 }
 
-TArray<float> SGMarkerReference::GetContactTimeFromTurning(UAnimSequence* AnimationSequence, FName BoneName)
-{
-	int NumFrame = AnimationSequence->GetNumberOfFrames()-1;
-	float Threshold = 0.25;
-	
-	FTransform LastFrameTransform, CurFrameTransform, NextFrameTransform;
-	TArray<float> TurningPoints, Results;
-
-	// 遍历每一帧的位置数据，找到方向转折点
-	for (int i = 0; i < NumFrame; i++)
-	{
-		int l = (i == 0) ? NumFrame-1 : i-1;
-		int n = (i == NumFrame-1) ? 0 : i+1;
-		
-		LastFrameTransform = FAnimCurveToolModule::GetBoneTMRelativeToRoot(AnimationSequence, BoneName, l);
-		CurFrameTransform = FAnimCurveToolModule::GetBoneTMRelativeToRoot(AnimationSequence, BoneName, i);
-		NextFrameTransform = FAnimCurveToolModule::GetBoneTMRelativeToRoot(AnimationSequence, BoneName, n);
-		
-		if (IsTurningPoint(LastFrameTransform, CurFrameTransform, NextFrameTransform))
-		{
-			TurningPoints.Add(i);
-		}
-	}
-
-	// 检查所有方向转折点的之后几帧，找到稳定低高度的点
-	for (float t : TurningPoints)
-	{
-		int n;
-		while (true)
-		{
-			n = (t == NumFrame-1) ? 0 : t+1;
-			CurFrameTransform = FAnimCurveToolModule::GetBoneTMRelativeToRoot(AnimationSequence, BoneName, t);
-			NextFrameTransform = FAnimCurveToolModule::GetBoneTMRelativeToRoot(AnimationSequence, BoneName, n);
-
-			// 脚部的下降幅度小于阈值（或者已为负数），进行标记
-			if (CurFrameTransform.GetLocation().Z - NextFrameTransform.GetLocation().Z < Threshold)
-			{
-				Results.Add(AnimationSequence->GetTimeAtFrame(n));
-				UE_LOG(LogTemp, Warning, TEXT("%s %s: %d"), *AnimationSequence->GetName(), *BoneName.ToString(), n);
-				break;
-			}
-			//否则先不进行标记，等待一个更稳定的低点
-			else
-			{
-				t = n;
-			}
-		}
-	}
-	
-	return Results;
-}
-
-bool SGMarkerReference::IsTurningPoint(FTransform LastFrame, FTransform CurFrame, FTransform NextFrame)
-{
-	FVector l = LastFrame.GetLocation();
-	FVector c = CurFrame.GetLocation();
-	FVector n = NextFrame.GetLocation();
-	
-	if (Dir == Direction::l)
-	{
-		return l.X < c.X && c.X > n.X;
-	}
-	else if (Dir == Direction::r)
-	{
-		return l.X > c.X && c.X < n.X;
-	}
-
-	if (Dir == Direction::f || Dir == Direction::lf ||Dir == Direction::rf)
-	{
-		return l.Y < c.Y && c.Y > n.Y;
-	}
-	else
-	{
-		return l.Y > c.Y && c.Y < n.Y;
-	}
-}
-
-
 void FAnimCurveToolModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
@@ -277,6 +375,9 @@ void FAnimCurveToolModule::StartupModule()
 
 	// 初始化成员的入口
 	InitializeMembers();
+
+	// 映射上次保存的步态缓存
+	GaitCache.Open(FGaitCache::GetDefaultFilename());
 }
 
 void FAnimCurveToolModule::ShutdownModule()
@@ -293,6 +394,15 @@ void FAnimCurveToolModule::ShutdownModule()
 	FAnimCurveToolCommands::Unregister();
 
 	FGlobalTabmanager::Get()->UnregisterNomadTabSpawner(AnimCurveToolTabName);
+
+	// 取消并等待后台分析结束，之后不再写入基准组
+	CancelReferenceAnalysis();
+	for (FRetiredReferenceBatch & Retired : RetiredReferenceBatches)
+	{
+		Retired.Task.Wait();
+	}
+	RetiredReferenceBatches.Reset();
+	GaitCache.Close();
 }
 
 void FAnimCurveToolModule::RegisterMenus()
@@ -334,15 +444,13 @@ TSharedRef<SDockTab> FAnimCurveToolModule::OnSpawnPluginTab(const FSpawnTabArgs&
                     MakeAnimPicker()
                 ]
             ]
-			/* 不再使用的曲线提取工具
 			+ SHorizontalBox::Slot().HAlign(HAlign_Center).AutoWidth()
 			[
 				SNew(SBorder)
 				[
-					MakeCurveExtractor()      	
+					MakeCurveBaker()
 				]
 			]
-			*/
 			+ SHorizontalBox::Slot().HAlign(HAlign_Center).AutoWidth()
             [
 	            SNew(SBorder)
@@ -371,11 +479,16 @@ void FAnimCurveToolModule::PluginButtonClicked()
 
 void FAnimCurveToolModule::InitializeMembers()
 {
-	/* 曲线提取工具相关的成员，已经不再使用了
+	/* 曲线烘焙工具相关的成员 */
 	TransScale = FText::FromString("1");
 	RotScale = FText::FromString("1");
+	KeyTolerance = FText::FromString("0.01");
+	ContactBlendTime = FText::FromString("0.1");
+	LockBlendTime = FText::FromString("0.1");
+	bPhaseHalfCycle = false;
 	SavePath = "/Game";
-	AnimSequenceToExtract = nullptr;
+	bBakeRootRelative = false;
+	bBakeToCurveAsset = false;
 	
 	OutputBoxStateMap.Add("TranslationX", false);
 	OutputBoxStateMap.Add("TranslationY", false);
@@ -389,12 +502,18 @@ void FAnimCurveToolModule::InitializeMembers()
 	OutputBoxStateMap.Add("ScaleY", false);
 	OutputBoxStateMap.Add("ScaleZ", false);
 	OutputBoxStateMap.Add("ScaleAll", false);
-	*/
 
 	FootLeft = FName(*FString("LeftToeBase"));
 	FootRight = FName(*FString("RightToeBase"));
 
 	ContactTolerance = FText::FromString("0.5");
+	ContactDetectorName = IContactDetector::GetDetectors()[0]->GetName();
+	bSubFrameRefine = true;
+	AnalysisStride = FText::FromString("1");
+	TrajectoryCacheBudget = FText::FromString("256");
+	FTrajectoryCache::Get().SetBudget(256ll * 1024 * 1024);
+	bVerifyAnalysis = false;
+	RefAnimSeuquence = nullptr;
 }
 
 TSharedRef<SWidget> FAnimCurveToolModule::MakeAnimPicker()
@@ -424,11 +543,9 @@ TSharedRef<SWidget> FAnimCurveToolModule::MakeAnimPicker()
     	    SNew(STextBlock)
     	    .Text(FText::FromString("Current Group"))
     	]
-    	+ SVerticalBox::Slot().AutoHeight().HAlign(HAlign_Center).Padding(20, 0, 20, 0)
+    	+ SVerticalBox::Slot().AutoHeight().Padding(20, 0, 20, 0)
     	[
-    	    SAssignNew(SelectedAnimGroupPreview, STextBlock)
-    	    .Text(FText::FromString("None"))
-    	    .AutoWrapText(true)
+    	    MakeAnimGroupList(SelectedAnimGroupPreview)
     	];
 
 	return AnimPicker;
@@ -437,16 +554,19 @@ TSharedRef<SWidget> FAnimCurveToolModule::MakeAnimPicker()
 FReply FAnimCurveToolModule::AddFromContentBrowser()
 {
 	TArray<FAssetData> Data;
+	TArray<UAnimSequence*> AddedAnims;
 	FModuleManager::LoadModuleChecked<FContentBrowserModule>( "ContentBrowser" ).Get().GetSelectedAssets(Data);
+	SelectedAnimGroup.Reserve(SelectedAnimGroup.Num() + Data.Num());
 	for (FAssetData & d : Data)
 	{
 		UAnimSequence * Anim = Cast<UAnimSequence>(d.GetAsset());
-		if (Anim && SelectedAnimGroup.Find(Anim) == INDEX_NONE)
+		if (Anim && SelectedAnimGroup.Add(Anim))
 		{
-			SelectedAnimGroup.Add(Anim);			
+			AddedAnims.Add(Anim);
 		}
 	}
-	UpdatePreviewText(SelectedAnimGroup, SelectedAnimGroupPreview.ToSharedRef());
+	// 只向预览列表追加新加入的动画
+	SelectedAnimGroupPreview->AddItems(AddedAnims);
 	UpdateAnimGroupToScale();
 	return FReply::Handled();
 }
@@ -455,7 +575,7 @@ FReply FAnimCurveToolModule::ResetSelectedAnimGroup()
 {
 	SelectedAnimGroup.Reset();
 	UpdateAnimGroupToScale();
-	UpdatePreviewText(SelectedAnimGroup, SelectedAnimGroupPreview.ToSharedRef());
+	SelectedAnimGroupPreview->ResetItems();
 	return FReply::Handled();
 }
 
@@ -476,11 +596,9 @@ TSharedRef<SWidget> FAnimCurveToolModule::MakePlaySpeedScaler()
             SNew(STextBlock)
             .Text(FText::FromString("Animation List"))
         ]
-        + SVerticalBox::Slot().AutoHeight().HAlign(HAlign_Center).Padding(20, 0, 20, 0)
+        + SVerticalBox::Slot().AutoHeight().Padding(20, 0, 20, 0)
         [
-            SAssignNew(AnimSequencesToScalePreview, STextBlock)
-            .Text(FText::FromString("None"))
-            .AutoWrapText(true)
+            MakeAnimGroupList(AnimSequencesToScalePreview)
         ];
 	
 	TSharedRef<SWidget> SpeedScaler =
@@ -510,11 +628,22 @@ TSharedRef<SWidget> FAnimCurveToolModule::MakePlaySpeedScaler()
                    SNew(STextBlock)
                    .Text(FText::FromString("Postfix Filter"))
                ]
-			+ SVerticalBox::Slot().AutoHeight().Padding(0, 0, 0, 20)
+			+ SVerticalBox::Slot().AutoHeight()
                [
                    SNew(SEditableTextBox)
                    .Text_Raw(this, &FAnimCurveToolModule::GetAnimPostfix)
                    .OnTextCommitted_Raw(this, &FAnimCurveToolModule::OnAnimPostfixCommitted)
+               ]
+			+ SVerticalBox::Slot().AutoHeight()
+               [
+                   SNew(STextBlock)
+                   .Text(FText::FromString("Name Rules (glob / re:regex, -exclude, ';' separated)"))
+               ]
+			+ SVerticalBox::Slot().AutoHeight().Padding(0, 0, 0, 20)
+               [
+                   SNew(SEditableTextBox)
+                   .Text_Raw(this, &FAnimCurveToolModule::GetAnimNameRules)
+                   .OnTextCommitted_Raw(this, &FAnimCurveToolModule::OnAnimNameRulesCommitted)
                ]
             + SVerticalBox::Slot().AutoHeight()
                 [
@@ -546,6 +675,12 @@ TSharedRef<SWidget> FAnimCurveToolModule::MakePlaySpeedScaler()
                      .OnClicked_Raw(this, &FAnimCurveToolModule::ApplyRootMotionSpeed)
                      .Text(FText::FromString("Apply Root Motion Speed"))
                 ]
+            + SVerticalBox::Slot().AutoHeight().Padding(0, 5, 0, 0)
+                [
+                     SNew(SButton)
+                     .OnClicked_Raw(this, &FAnimCurveToolModule::BakeDistanceCurvesOnClicked)
+                     .Text(FText::FromString("Bake Distance Curves"))
+                ]
             + SVerticalBox::Slot().AutoHeight().Padding(0, 20, 0, 0)
             [
                 SelectedAnimPreview		
@@ -581,22 +716,51 @@ FReply FAnimCurveToolModule::ApplyRootMotionSpeed() const
 	return FReply::Handled();
 }
 
+FReply FAnimCurveToolModule::BakeDistanceCurvesOnClicked()
+{
+	// 静止阈值为动画最大速度的比例
+	const float StopSpeedRatio = 0.1f;
+	const float Tolerance = GetKeyToleranceValue();
+
+	TArray<FBakedAnimCurves> BakedAnims;
+	TArray<EDistanceClipType> ClipTypes;
+	BakedAnims.SetNum(AnimSequencesToScale.Num());
+	ClipTypes.SetNum(AnimSequencesToScale.Num());
+	ParallelFor(AnimSequencesToScale.Num(), [&](int32 Index)
+	{
+		FCurveBakeResult Result;
+		if (FDistanceCurveBaker::MakeDistanceCurve(AnimSequencesToScale[Index], StopSpeedRatio, Result, ClipTypes[Index]))
+		{
+			BakedAnims[Index].AnimSequence = Result.AnimSequence;
+			FCurveBaker::MakeBakedCurves(Result, Tolerance, BakedAnims[Index].Curves);
+		}
+	});
+
+	for (int32 Index = 0; Index < BakedAnims.Num(); Index++)
+	{
+		if (BakedAnims[Index].AnimSequence)
+		{
+			UE_LOG(LogTemp, Log, TEXT("Distance curve for %s: %s"), *BakedAnims[Index].AnimSequence->GetName(), *FDistanceCurveBaker::GetClipTypeName(ClipTypes[Index]));
+		}
+	}
+
+	WriteBakedCurves(BakedAnims, false);
+	return FReply::Handled();
+}
+
 bool FAnimCurveToolModule::CheckShouldSelectAnim(FAssetData Asset) const
 {
-	FString Prefix = AnimPrefix.ToString();
-	FString Postfix = AnimPostfix.ToString();
-			
-	return ( (Prefix.Len() == 0 || Asset.AssetName.ToString().StartsWith(AnimPrefix.ToString(), ESearchCase::CaseSensitive))
-        && (Postfix.Len() == 0  || Asset.AssetName.ToString().EndsWith(AnimPostfix.ToString(), ESearchCase::CaseSensitive)));
+	return AnimFilter.PassesFilter(Asset.AssetName.ToString());
 }
 
 bool FAnimCurveToolModule::CheckShouldSelectAnim(UAnimSequence* AnimSequence) const
 {
-	FString Prefix = AnimPrefix.ToString();
-	FString Postfix = AnimPostfix.ToString();
-			
-	return ( (Prefix.Len() == 0 || AnimSequence->GetName().StartsWith(AnimPrefix.ToString(), ESearchCase::CaseSensitive))
-        && (Postfix.Len() == 0  || AnimSequence->GetName().EndsWith(AnimPostfix.ToString(), ESearchCase::CaseSensitive)));
+	return AnimFilter.PassesFilter(AnimSequence->GetName());
+}
+
+void FAnimCurveToolModule::CompileAnimFilter()
+{
+	AnimFilter.Compile(AnimPrefix.ToString(), AnimPostfix.ToString(), AnimNameRules.ToString());
 }
 
 FReply FAnimCurveToolModule::ApplyRateScale() const
@@ -609,10 +773,6 @@ FReply FAnimCurveToolModule::ApplyRateScale() const
 }
 
 /*
-void FAnimCurveToolModule::OnSavePathSelected(const FString& NewPath)
-{
-	SavePath = NewPath;
-}
 void FAnimCurveToolModule::OnAnimToScalePathSelected(const FString& NewPath)
 {
 	AnimToScalePath = NewPath;
@@ -652,30 +812,35 @@ bool FAnimCurveToolModule::UpdateFilteredAnim(TArray<UAnimSequence*> & TargetAni
 
 void FAnimCurveToolModule::UpdateAnimGroupToScale()
 {
-	AnimSequencesToScale.Reset();
-	for (UAnimSequence * Anim : SelectedAnimGroup)
+	// SelectedAnimGroup本身已去重，筛选结果无需再次查重
+	AnimSequencesToScale.Reset(SelectedAnimGroup.Num());
+	if (AnimFilter.IsEmpty())
+	{
+		AnimSequencesToScale.Append(SelectedAnimGroup.GetArray());
+	}
+	else
 	{
-		if (CheckShouldSelectAnim(Anim) &&
-			AnimSequencesToScale.Find(Anim) == INDEX_NONE)
+		for (UAnimSequence * Anim : SelectedAnimGroup)
 		{
-			AnimSequencesToScale.Add(Anim);
+			if (CheckShouldSelectAnim(Anim))
+			{
+				AnimSequencesToScale.Add(Anim);
+			}
 		}
 	}
-	UpdatePreviewText(AnimSequencesToScale, AnimSequencesToScalePreview.ToSharedRef());
-	
+	AnimSequencesToScalePreview->SetItems(AnimSequencesToScale);
 }
 
-void FAnimCurveToolModule::UpdatePreviewText(TArray<UAnimSequence*> & TargetAnimSequences, TSharedRef<STextBlock> PreviewTextWidget)
+TSharedRef<SAnimGroupListView> FAnimCurveToolModule::MakeAnimGroupList(TSharedPtr<SAnimGroupListView>& OutList)
 {
-	FString SelectedAnimSequenceNames;
-	for (UAnimSequence * Anim : TargetAnimSequences)
-	{
-		SelectedAnimSequenceNames += Anim->GetName() + "\n";
-	}
-	if (SelectedAnimSequenceNames.Len() == 0)
-		SelectedAnimSequenceNames = "None";
-	
-	PreviewTextWidget->SetText(FText::FromString(SelectedAnimSequenceNames));
+	SAssignNew(OutList, SAnimGroupListView)
+	.OnGetReference_Raw(this, &FAnimCurveToolModule::FindAnimReference);
+	return OutList.ToSharedRef();
+}
+
+const SGMarkerReference* FAnimCurveToolModule::FindAnimReference(UAnimSequence* AnimSequence) const
+{
+	return AnimReferenceGroup.Find(AnimSequence);
 }
 
 FText FAnimCurveToolModule::GetAnimPrefix() const
@@ -688,6 +853,11 @@ FText FAnimCurveToolModule::GetAnimPostfix() const
 	return AnimPostfix;
 }
 
+FText FAnimCurveToolModule::GetAnimNameRules() const
+{
+	return AnimNameRules;
+}
+
 FText FAnimCurveToolModule::GetRateScale() const
 {
 	return RateScale;
@@ -708,6 +878,7 @@ FText FAnimCurveToolModule::GetTolerance() const
 void FAnimCurveToolModule::OnAnimPrefixCommitted(const FText& InText, ETextCommit::Type CommitInfo)
 {
 	AnimPrefix = InText;
+	CompileAnimFilter();
 	UpdateAnimGroupToScale();
 	//UpdateFilteredAnim(AnimSequencesToScale, AnimSequencesToScalePreview.ToSharedRef(), AnimToScalePath);
 
@@ -716,11 +887,19 @@ void FAnimCurveToolModule::OnAnimPrefixCommitted(const FText& InText, ETextCommi
 void FAnimCurveToolModule::OnAnimPostfixCommitted(const FText& InText, ETextCommit::Type CommitInfo)
 {
 	AnimPostfix = InText;
+	CompileAnimFilter();
 	UpdateAnimGroupToScale();
 
 	//UpdateFilteredAnim(AnimSequencesToScale, AnimSequencesToScalePreview.ToSharedRef(), AnimToScalePath);
 }
 
+void FAnimCurveToolModule::OnAnimNameRulesCommitted(const FText& InText, ETextCommit::Type CommitInfo)
+{
+	AnimNameRules = InText;
+	CompileAnimFilter();
+	UpdateAnimGroupToScale();
+}
+
 void FAnimCurveToolModule::OnRateScaleCommitted(const FText& InText, ETextCommit::Type CommitInfo)
 {
 	RateScale = InText;
@@ -751,8 +930,11 @@ void FAnimCurveToolModule::OnRightFootBoneCommitted(const FText& InText, ETextCo
 
 FReply FAnimCurveToolModule::ClearReferenceGroup()
 {
+	CancelReferenceAnalysis();
 	AnimReferenceGroup.Reset();
-	AnimReferenceGroupPreview->SetText(FText::FromString("None"));
+	AnimReferenceGroupPreview->ResetItems();
+	SelectedAnimGroupPreview->RefreshAllStatus();
+	AnimSequencesToScalePreview->RefreshAllStatus();
 	return FReply::Handled();
 }
 
@@ -797,11 +979,9 @@ TSharedRef<SWidget> FAnimCurveToolModule::MakeSGMarkerWidget()
             SNew(STextBlock)
             .Text(FText::FromString("Animations that have been processed"))
         ]
-        + SVerticalBox::Slot().AutoHeight().HAlign(HAlign_Center).Padding(20, 0, 20, 0)
+        + SVerticalBox::Slot().AutoHeight().Padding(20, 0, 20, 0)
         [
-            SAssignNew(AnimReferenceGroupPreview, STextBlock)
-            .Text(FText::FromString("None"))
-            .AutoWrapText(true)
+            MakeAnimGroupList(AnimReferenceGroupPreview)
         ];
 
 	// ComboButton + AssetPicker for ref anim sequence
@@ -848,7 +1028,6 @@ TSharedRef<SWidget> FAnimCurveToolModule::MakeSGMarkerWidget()
         ];
 
 	// Editable text widget for plane height
-	/*
 	TSharedRef<SWidget> PlaneHeightWidget =
         SNew(SHorizontalBox)
         + SHorizontalBox::Slot()
@@ -865,7 +1044,6 @@ TSharedRef<SWidget> FAnimCurveToolModule::MakeSGMarkerWidget()
             .Text_Raw(this, &FAnimCurveToolModule::GetTolerance)
             .OnTextCommitted_Raw(this, &FAnimCurveToolModule::OnToleranceCommitted)
         ];
-	*/
 	
 	TSharedRef<SWidget> SGMarkerWidget =
 		SNew(SHorizontalBox)
@@ -913,12 +1091,27 @@ TSharedRef<SWidget> FAnimCurveToolModule::MakeSGMarkerWidget()
     		    .Text_Raw(this, &FAnimCurveToolModule::GetRightFootBone)
     		    .OnTextCommitted_Raw(this, &FAnimCurveToolModule::OnRightFootBoneCommitted)
     		]
+    		+ SVerticalBox::Slot().AutoHeight().Padding(0, 5, 0, 0).VAlign(VAlign_Center)
+    		[
+    		    MakeContactDetectorPicker()
+    		]
+    		+ SVerticalBox::Slot().AutoHeight().Padding(0, 5, 0, 0).VAlign(VAlign_Center)
+    		[
+    		    PlaneHeightWidget
+    		]
     		+ SVerticalBox::Slot().AutoHeight().Padding(0, 5, 0, 5).VAlign(VAlign_Center)
             [
                 SNew(SButton)
                 .OnClicked_Raw(this, &FAnimCurveToolModule::AddAllReferenceGroup)
+                .IsEnabled_Raw(this, &FAnimCurveToolModule::IsReferenceGroupReady)
                 .Text(FText::FromString("Precalculate"))
             ]
+            + SVerticalBox::Slot().AutoHeight().Padding(0, 0, 0, 5).VAlign(VAlign_Center)
+            [
+                SNew(SButton)
+                .OnClicked_Raw(this, &FAnimCurveToolModule::CompareDetectorsOnClicked)
+                .Text(FText::FromString("Compare Detectors on Selection"))
+            ]
             + SVerticalBox::Slot().AutoHeight().Padding(0, 5, 0, 5).VAlign(VAlign_Center)
             [
                 SNew(SButton)
@@ -933,7 +1126,71 @@ TSharedRef<SWidget> FAnimCurveToolModule::MakeSGMarkerWidget()
             [
                 SNew(SButton)
                 .OnClicked_Raw(this, &FAnimCurveToolModule::AddDefaultMarkerForReferenceGroup)
+                .IsEnabled_Raw(this, &FAnimCurveToolModule::IsReferenceGroupReady)
                 .Text(FText::FromString("Add Default Markers to ReferenceGroup"))
+            ]
+            + SVerticalBox::Slot().AutoHeight().Padding(0, 5, 0, 0).VAlign(VAlign_Center)
+            [
+                SNew(SHorizontalBox)
+                + SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+                [
+                    SNew(STextBlock)
+                    .Text(FText::FromString("Contact Blend"))
+                ]
+                + SHorizontalBox::Slot().AutoWidth().Padding(5, 0, 10, 0).VAlign(VAlign_Center)
+                [
+                    SNew(SEditableTextBox)
+                    .MinDesiredWidth(40)
+                    .Text_Raw(this, &FAnimCurveToolModule::GetContactBlendTime)
+                    .OnTextCommitted_Raw(this, &FAnimCurveToolModule::OnContactBlendTimeCommitted)
+                ]
+                + SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+                [
+                    SNew(STextBlock)
+                    .Text(FText::FromString("Lock Blend"))
+                ]
+                + SHorizontalBox::Slot().AutoWidth().Padding(5, 0, 0, 0).VAlign(VAlign_Center)
+                [
+                    SNew(SEditableTextBox)
+                    .MinDesiredWidth(40)
+                    .Text_Raw(this, &FAnimCurveToolModule::GetLockBlendTime)
+                    .OnTextCommitted_Raw(this, &FAnimCurveToolModule::OnLockBlendTimeCommitted)
+                ]
+            ]
+            + SVerticalBox::Slot().AutoHeight().Padding(0, 5, 0, 5).VAlign(VAlign_Center)
+            [
+                SNew(SButton)
+                .OnClicked_Raw(this, &FAnimCurveToolModule::BakeFootCurvesOnClicked)
+                .IsEnabled_Raw(this, &FAnimCurveToolModule::IsReferenceGroupReady)
+                .Text(FText::FromString("Bake Foot Contact / Lock Curves"))
+            ]
+            + SVerticalBox::Slot().AutoHeight().Padding(0, 5, 0, 5).VAlign(VAlign_Center)
+            [
+                SNew(SHorizontalBox)
+                + SHorizontalBox::Slot().AutoWidth().Padding(0, 0, 10, 0).VAlign(VAlign_Center)
+                [
+                    SNew(SCheckBox)
+                    .IsChecked_Lambda([this]() { return bPhaseHalfCycle ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+                    .OnCheckStateChanged_Lambda([this](ECheckBoxState NewState) { bPhaseHalfCycle = NewState == ECheckBoxState::Checked; })
+                    [
+                        SNew(STextBlock)
+                        .Text(FText::FromString("Half-Cycle Phase"))
+                    ]
+                ]
+                + SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+                [
+                    SNew(SButton)
+                    .OnClicked_Raw(this, &FAnimCurveToolModule::BakePhaseCurvesOnClicked)
+                    .IsEnabled_Raw(this, &FAnimCurveToolModule::IsReferenceGroupReady)
+                    .Text(FText::FromString("Bake Gait Phase Curves"))
+                ]
+            ]
+            + SVerticalBox::Slot().AutoHeight().Padding(0, 5, 0, 5).VAlign(VAlign_Center)
+            [
+                SNew(SButton)
+                .OnClicked_Raw(this, &FAnimCurveToolModule::BakeGaitTablesOnClicked)
+                .IsEnabled_Raw(this, &FAnimCurveToolModule::IsReferenceGroupReady)
+                .Text(FText::FromString("Bake Runtime Gait Tables"))
             ]
 		]
 		+ SHorizontalBox::Slot().AutoWidth().Padding(15, 0, 15, 0)
@@ -961,6 +1218,36 @@ TSharedRef<SWidget> FAnimCurveToolModule::MakeSGMarkerWidget()
 				SNew(SButton)
 				.Text(FText::FromString("Sync Reference Group"))
 				.OnClicked_Raw(this, &FAnimCurveToolModule::SyncReferenceGroupOnClicked)
+				.IsEnabled_Raw(this, &FAnimCurveToolModule::IsReferenceGroupReady)
+            ]
+            +SVerticalBox::Slot().AutoHeight().Padding(0, 0, 0, 5)
+            [
+				SNew(SButton)
+				.Text(FText::FromString("Add Ref Animation + Track to Sync Job"))
+				.OnClicked_Raw(this, &FAnimCurveToolModule::AddToSyncJobOnClicked)
+            ]
+            +SVerticalBox::Slot().AutoHeight().Padding(0, 0, 0, 5)
+            [
+				SAssignNew(SyncJobPreview, STextBlock)
+				.Text(FText::FromString("Sync Job: None"))
+				.AutoWrapText(true)
+            ]
+            +SVerticalBox::Slot().AutoHeight().Padding(0, 0, 0, 5)
+            [
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot().AutoWidth().Padding(0, 0, 5, 0)
+				[
+					SNew(SButton)
+					.Text(FText::FromString("Run Sync Job"))
+					.OnClicked_Raw(this, &FAnimCurveToolModule::RunSyncJobOnClicked)
+					.IsEnabled_Raw(this, &FAnimCurveToolModule::IsReferenceGroupReady)
+				]
+				+ SHorizontalBox::Slot().AutoWidth()
+				[
+					SNew(SButton)
+					.Text(FText::FromString("Clear Sync Job"))
+					.OnClicked_Raw(this, &FAnimCurveToolModule::ClearSyncJobOnClicked)
+				]
             ]
 		];
 	return SGMarkerWidget;
@@ -1004,150 +1291,800 @@ TSharedRef<SWidget> FAnimCurveToolModule::OnGetRefAnimMenu()
 
 FReply FAnimCurveToolModule::AddAllReferenceGroup()
 {
-	AddToReferenceGroup(SelectedAnimGroup, AnimReferenceGroup);
+	AddToReferenceGroup(SelectedAnimGroup.GetArray(), AnimReferenceGroup);
 	return FReply::Handled();
 }
 
-void FAnimCurveToolModule::AddToReferenceGroup(TArray<UAnimSequence*>& AnimSequences, TMap<UAnimSequence*, SGMarkerReference>& ReferenceGroup)
+void FAnimCurveToolModule::AddToReferenceGroup(const TArray<UAnimSequence*>& AnimSequences, TMap<UAnimSequence*, SGMarkerReference>& ReferenceGroup)
 {
-	for (UAnimSequence* Anim : AnimSequences)
+	// 上一批的结果还没有全部写入时，不启动新的一批
+	if (ReferenceDrainHandle.IsValid())
 	{
-	
-		if (ReferenceGroup.Find(Anim) == nullptr)
-		{
-			if (Anim->GetSkeleton()->GetReferenceSkeleton().FindRawBoneIndex(FootLeft) == INDEX_NONE)
-			{
-				UE_LOG(LogTemp, Warning, TEXT("Bone %s not found in animation %s"), *FootLeft.ToString(), *Anim->GetName());
-				continue;
-			}
-
-			if (Anim->GetSkeleton()->GetReferenceSkeleton().FindRawBoneIndex(FootRight) == INDEX_NONE)
-			{
-				UE_LOG(LogTemp, Warning, TEXT("Bone %s not found in animation %s"), *FootRight.ToString(), *Anim->GetName());
-				continue;
-			}
-			SGMarkerReference ref = SGMarkerReference(Anim, FootLeft, FootRight);
-			if (ref.bIsValid)
-			{
-				ReferenceGroup.Add(Anim, ref);
-			}
-		}
+		UE_LOG(LogTemp, Warning, TEXT("Reference analysis is still running, %d animations pending."), NumPendingReferences);
+		return;
 	}
 
-	TArray<UAnimSequence*> PreviewAnimSequence;
-	for (auto e : ReferenceGroup)
+	const IContactDetector * Detector = IContactDetector::FindDetector(ContactDetectorName);
+	if (Detector == nullptr)
 	{
-		PreviewAnimSequence.Add(e.Key);
+		Detector = &IContactDetector::GetDetectors()[0].Get();
 	}
+	const FContactDetectorSettings Settings = MakeContactDetectorSettings();
 
-	UpdatePreviewText(PreviewAnimSequence, AnimReferenceGroupPreview.ToSharedRef());
-}
+	// 游戏线程上筛选需要计算的动画
+	TArray<UAnimSequence*> Candidates;
+	TSet<UAnimSequence*> SeenAnims;
+	for (UAnimSequence* Anim : AnimSequences)
+	{
+		bool bAlreadySeen = false;
+		SeenAnims.Add(Anim, &bAlreadySeen);
+		if (bAlreadySeen || ReferenceGroup.Find(Anim) != nullptr)
+		{
+			continue;
+		}
 
-FReply FAnimCurveToolModule::SyncReferenceGroupOnClicked()
-{
-	SyncReferenceGroup(RefAnimSeuquence, RefTrackName);
+		if (Anim->GetSkeleton()->GetReferenceSkeleton().FindRawBoneIndex(FootLeft) == INDEX_NONE)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Bone %s not found in animation %s"), *FootLeft.ToString(), *Anim->GetName());
+			continue;
+		}
 
-	return FReply::Handled();
-}
+		if (Anim->GetSkeleton()->GetReferenceSkeleton().FindRawBoneIndex(FootRight) == INDEX_NONE)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Bone %s not found in animation %s"), *FootRight.ToString(), *Anim->GetName());
+			continue;
+		}
+		Candidates.Add(Anim);
+	}
 
-void FAnimCurveToolModule::SyncReferenceGroup(UAnimSequence* RefAnimSequence, FName TrackName)
-{
-	// Sanity Check
-	if (AnimReferenceGroup.Find(RefAnimSequence) == nullptr)
+	if (Candidates.Num() == 0)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Animation %s doesn't belong to the current reference group being processed."), *RefAnimSequence->GetName());
 		return;
 	}
-	const bool bExistingTrackName = GetTrackIndexForAnimationNotifyTrackName(RefAnimSequence, TrackName) != INDEX_NONE;
-	if (!bExistingTrackName)
+
+	// 上一批的任务可能还在结束已开始的动画，其引用保留到任务结束，不等待
+	RetireReferenceBatch();
+	for (UAnimSequence* Anim : Candidates)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Track %s not found in animation %s."), *TrackName.ToString(), *RefAnimSequence->GetName());
-		return;
+		ReferenceBatchAnims.Emplace(Anim);
 	}
-	const int32 TrackIndex = GetTrackIndexForAnimationNotifyTrackName(RefAnimSequence, TrackName);
-	TArray<FAnimSyncMarker> AllMarkers;
-	TArray<FAnimNotifyEvent> AllNotifies;
 
-	
-	// 记录所有的同步标记
-	for (FAnimSyncMarker & m : RefAnimSequence->AuthoredSyncMarkers)
+	// 每个候选动画都会产生一个结果：缓存恢复，计算结果，或随相同内容的动画一起写入
+	const int32 BatchId = ReferenceBatchId.Increment();
+	ReferenceDrainGroup = &ReferenceGroup;
+	NumPendingReferences = Candidates.Num();
+	NumMirroredReferences = 0;
+	NumCachedReferences = 0;
+	ReferenceAddedAnims.Reset();
+	ReferenceFallbackAnims.Reset();
+	ReferenceFailedAnims.Reset();
+	ReferenceDrainHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FAnimCurveToolModule::DrainReferenceResults));
+
+	// 哈希、缓存查找与分析都在后台进行，每个动画完成后立即放入无锁队列，游戏线程每帧取出一部分
+	ReferenceAnalysisTask = Async(EAsyncExecution::ThreadPool, [this, BatchId, Candidates, Detector, Settings, LeftFoot = FootLeft, RightFoot = FootRight, bVerify = bVerifyAnalysis]()
 	{
-		if (m.TrackIndex == TrackIndex)
+		// 步态缓存中动画标识与设置都未变的动画直接恢复，不读取轨道数据
+		// 批次进行中缓存文件不会被重写，工作线程可以直接读取映射内存
+		const uint64 SettingsHash = FGaitCache::MakeSettingsHash(LeftFoot, RightFoot, Detector->GetName(), Settings);
+		TArray<UAnimSequence*> Misses;
+		TMap<uint64, FGaitCacheEntryView> CachedViews;
+		for (UAnimSequence * Anim : Candidates)
+		{
+			FGaitCacheEntryView CacheView;
+			if (!GaitCache.Find(Anim->GetPathName(), FGaitCache::MakeIdentityHash(Anim, { LeftFoot, RightFoot }), SettingsHash, CacheView))
+			{
+				Misses.Add(Anim);
+				continue;
+			}
+
+			// 记录命中项的数据哈希，内容相同的未命中动画直接复制这一结果
+			CachedViews.Add(CacheView.Entry->DataHash, CacheView);
+			FReferenceAnalysisResult Cached;
+			Cached.AnimSequence = Anim;
+			Cached.BatchId = BatchId;
+			Cached.bFromCache = true;
+			Cached.Reference = MakeUnique<SGMarkerReference>(Anim, CacheView);
+			ReferenceResults.Enqueue(MoveTemp(Cached));
+		}
+
+		// 只对未命中的动画计算原始轨道数据与脚部骨骼链的内容哈希，加上方向标签与分析设置，结果相同的动画哈希相同
+		TArray<uint64> MissHashes;
+		MissHashes.SetNumZeroed(Misses.Num());
+		ParallelFor(Misses.Num(), [&](int32 Index)
+		{
+			UAnimSequence * Anim = Misses[Index];
+			Direction AnimDir = Direction::f;
+			SGMarkerReference::GetDirectionFromName(Anim->GetName(), AnimDir);
+			// 批次已取消时不再读取剩余动画的轨道数据
+			if (ReferenceBatchId.GetValue() != BatchId)
+			{
+				return;
+			}
+			const FSHAHash ContentHash = FGaitCache::MakeContentHash(Anim, { LeftFoot, RightFoot });
+			MissHashes[Index] = FGaitCache::MakeDataHash(ContentHash, (uint8)AnimDir, SettingsHash);
+		});
+
+		if (ReferenceBatchId.GetValue() != BatchId)
+		{
+			return;
+		}
+
+		// 每个哈希只计算一次，与缓存命中项或先出现的动画内容相同时共用结果
+		TArray<UAnimSequence*> PendingAnims;
+		TArray<uint64> PendingHashes;
+		TMap<uint64, int32> HashLeaders;
+		TMap<UAnimSequence*, TArray<UAnimSequence*>> Duplicates;
+		int32 NumDuplicates = 0;
+		int32 NumCacheCopies = 0;
+		for (int32 Index = 0; Index < Misses.Num(); Index++)
+		{
+			UAnimSequence * Anim = Misses[Index];
+			const uint64 DataHash = MissHashes[Index];
+			if (const FGaitCacheEntryView * CacheView = CachedViews.Find(DataHash))
+			{
+				// 结果写入这一动画自己的缓存项，因此不标记为缓存恢复
+				FReferenceAnalysisResult Copied;
+				Copied.AnimSequence = Anim;
+				Copied.BatchId = BatchId;
+				Copied.Reference = MakeUnique<SGMarkerReference>(Anim, *CacheView);
+				ReferenceResults.Enqueue(MoveTemp(Copied));
+				NumCacheCopies++;
+				continue;
+			}
+
+			if (const int32 * Leader = HashLeaders.Find(DataHash))
+			{
+				Duplicates.FindOrAdd(PendingAnims[*Leader]).Add(Anim);
+				NumDuplicates++;
+				continue;
+			}
+			HashLeaders.Add(DataHash, PendingAnims.Num());
+			PendingAnims.Add(Anim);
+			PendingHashes.Add(DataHash);
+		}
+		if (NumCacheCopies > 0)
+		{
+			UE_LOG(LogTemp, Log, TEXT("Reference group: %d animations copied from cached animations with the same content."), NumCacheCopies);
+		}
+		if (NumDuplicates > 0)
 		{
-			AllMarkers.Add(m);
+			UE_LOG(LogTemp, Log, TEXT("Reference group: %d duplicate animations share the analysis of %d unique animations."), NumDuplicates, Duplicates.Num());
+		}
+
+		// 按命名找出左右镜像的动画对，后一个动画在同一任务中确认镜像后由前一个动画的结果推出
+		TMap<FString, int32> PendingNames;
+		for (int32 Index = 0; Index < PendingAnims.Num(); Index++)
+		{
+			PendingNames.Add(PendingAnims[Index]->GetName(), Index);
+		}
+		TArray<int32> MirrorOf;
+		MirrorOf.Init(INDEX_NONE, PendingAnims.Num());
+		TArray<bool> IsMirrorFollower;
+		IsMirrorFollower.Init(false, PendingAnims.Num());
+		for (int32 Index = 0; Index < PendingAnims.Num(); Index++)
+		{
+			FString MirrorName;
+			if (IsMirrorFollower[Index] || !SGMarkerReference::GetMirrorName(PendingAnims[Index]->GetName(), MirrorName))
+			{
+				continue;
+			}
+			const int32 * MirrorIndex = PendingNames.Find(MirrorName);
+			if (MirrorIndex == nullptr || *MirrorIndex == Index || IsMirrorFollower[*MirrorIndex] || MirrorOf[*MirrorIndex] != INDEX_NONE
+				|| PendingAnims[*MirrorIndex]->GetSkeleton() != PendingAnims[Index]->GetSkeleton()
+				|| PendingAnims[*MirrorIndex]->GetNumberOfFrames() != PendingAnims[Index]->GetNumberOfFrames())
+			{
+				continue;
+			}
+			MirrorOf[Index] = *MirrorIndex;
+			IsMirrorFollower[*MirrorIndex] = true;
+		}
+
+		TArray<UAnimSequence*> PendingMirrors;
+		TArray<uint64> PendingMirrorHashes;
+		{
+			TArray<UAnimSequence*> Leaders;
+			TArray<uint64> LeaderHashes;
+			for (int32 Index = 0; Index < PendingAnims.Num(); Index++)
+			{
+				if (IsMirrorFollower[Index])
+				{
+					continue;
+				}
+				Leaders.Add(PendingAnims[Index]);
+				LeaderHashes.Add(PendingHashes[Index]);
+				PendingMirrors.Add(MirrorOf[Index] != INDEX_NONE ? PendingAnims[MirrorOf[Index]] : nullptr);
+				PendingMirrorHashes.Add(MirrorOf[Index] != INDEX_NONE ? PendingHashes[MirrorOf[Index]] : 0);
+			}
+			if (Leaders.Num() < PendingAnims.Num())
+			{
+				UE_LOG(LogTemp, Log, TEXT("Reference group: %d mirrored animation pairs found by name."), PendingAnims.Num() - Leaders.Num());
+			}
+			PendingAnims = MoveTemp(Leaders);
+			PendingHashes = MoveTemp(LeaderHashes);
+		}
+
+		// 按开销从大到小调度，长动画的采样与检测在内部再分块并行
+		TArray<int64> Costs;
+		TArray<int32> NumFrames;
+		for (int32 Index = 0; Index < PendingAnims.Num(); Index++)
+		{
+			// 镜像确认失败时另一个动画也在同一任务中计算，按最坏情况估计
+			UAnimSequence * Anim = PendingAnims[Index];
+			int64 Cost = FBatchScheduler::EstimateCost(Anim, { LeftFoot, RightFoot }, true);
+			if (PendingMirrors[Index] != nullptr)
+			{
+				Cost += FBatchScheduler::EstimateCost(PendingMirrors[Index], { LeftFoot, RightFoot }, true);
+			}
+			Costs.Add(Cost);
+			NumFrames.Add(Anim->GetNumberOfFrames());
+		}
+		TArray<FBatchJob> Jobs;
+		FBatchScheduler::MakeJobs(Costs, NumFrames, false, Jobs);
+
+		auto Analyze = [&](UAnimSequence* Anim, uint64 DataHash)
+		{
+			// 每个动画结束时释放这一工作线程的临时内存，下一个动画复用同一块内存
+			FMemMark Mark(FMemStack::Get());
+			FReferenceAnalysisResult Result;
+			Result.AnimSequence = Anim;
+			Result.BatchId = BatchId;
+			if (const TArray<UAnimSequence*> * AnimDuplicates = Duplicates.Find(Anim))
+			{
+				Result.Duplicates = *AnimDuplicates;
+			}
+
+			// 粗采样需要在检测前知道移动方向
+			FContactDetectorSettings AnimSettings = Settings;
+			SGMarkerReference::GetDirectionFromName(Anim->GetName(), AnimSettings.Dir);
+
+			// 缓存中的轨迹为全帧率采样，命中时不需要再采样
+			FFootTrajectory Trajectory;
+			bool bCached = FTrajectoryCache::Get().Find(Anim, { LeftFoot, RightFoot }, Trajectory);
+			if (!bCached && GaitCache.FindTrajectory(Anim, { LeftFoot, RightFoot }, Trajectory))
+			{
+				// 步态缓存文件中保存的轨迹同样为全帧率
+				FTrajectoryCache::Get().Add(Trajectory);
+				bCached = true;
+			}
+			if (bCached || Trajectory.SampleCoarseToFine(Anim, { LeftFoot, RightFoot }, *Detector, AnimSettings))
+			{
+				// 粗采样的轨迹含有插值的帧，不放入缓存
+				if (!bCached && Settings.AnalysisStride <= 1)
+				{
+					FTrajectoryCache::Get().Add(Trajectory);
+				}
+				Result.Reference = MakeUnique<SGMarkerReference>(Anim, LeftFoot, RightFoot, Trajectory, *Detector, Settings);
+				Result.Reference->CacheDataHash = DataHash;
+				Result.Reference->CacheSettingsHash = SettingsHash;
+				const SGMarkerReference & ref = *Result.Reference;
+
+				// 与全帧率的结果比较，确认粗采样的步长没有丢失或移动基准点
+				if (bVerify && !bCached && Settings.AnalysisStride > 1 && ref.bIsValid)
+				{
+					FFootTrajectory FullTrajectory;
+					if (FullTrajectory.Sample(Anim, { LeftFoot, RightFoot }, Settings.ChunkFrames))
+					{
+						const SGMarkerReference FullRef(Anim, LeftFoot, RightFoot, FullTrajectory, *Detector, Settings);
+						float Error = 0.f;
+						if (!GetMaxMarkerError(ref, FullRef, Error))
+						{
+							UE_LOG(LogTemp, Warning, TEXT("%s: coarse-to-fine analysis found a different number of markers than full-rate analysis."), *Anim->GetName());
+						}
+						else if (Error > Settings.VerifyTolerance)
+						{
+							UE_LOG(LogTemp, Warning, TEXT("%s: coarse-to-fine analysis differs from full-rate analysis by %.4fs."), *Anim->GetName(), Error);
+						}
+						else
+						{
+							UE_LOG(LogTemp, Log, TEXT("%s: coarse-to-fine analysis matches full-rate analysis (max error %.4fs)."), *Anim->GetName(), Error);
+						}
+					}
+				}
+			}
+			return Result;
+		};
+
+		FBatchScheduler::Run(Jobs, [&](const FBatchJob& Job)
+		{
+			// 批次已取消时跳过剩余的任务
+			if (ReferenceBatchId.GetValue() != BatchId)
+			{
+				return;
+			}
+
+			FReferenceAnalysisResult Result = Analyze(PendingAnims[Job.Item], PendingHashes[Job.Item]);
+
+			// 镜像动画：比较左右互换并沿X轴镜像后的脚部轨迹，一致时左右基准点互换即可，否则单独计算
+			if (UAnimSequence * Mirror = PendingMirrors[Job.Item])
+			{
+				FReferenceAnalysisResult MirrorResult;
+				MirrorResult.BatchId = BatchId;
+				if (Result.Reference.IsValid() && Result.Reference->bIsValid
+					&& FFootTrajectory::IsMirrorPair(Result.AnimSequence, { LeftFoot, RightFoot }, Mirror, { RightFoot, LeftFoot }, Settings.MirrorProbeFrames, Settings.MirrorTolerance))
+				{
+					MirrorResult.AnimSequence = Mirror;
+					MirrorResult.Reference = MakeUnique<SGMarkerReference>(Mirror, *Result.Reference);
+					MirrorResult.Reference->CacheDataHash = PendingMirrorHashes[Job.Item];
+					MirrorResult.Reference->CacheSettingsHash = SettingsHash;
+					if (const TArray<UAnimSequence*> * MirrorDuplicates = Duplicates.Find(Mirror))
+					{
+						MirrorResult.Duplicates = *MirrorDuplicates;
+					}
+				}
+				else
+				{
+					UE_LOG(LogTemp, Log, TEXT("%s is not a mirror of %s, analysing it separately."), *Mirror->GetName(), *Result.AnimSequence->GetName());
+					MirrorResult = Analyze(Mirror, PendingMirrorHashes[Job.Item]);
+				}
+				ReferenceResults.Enqueue(MoveTemp(MirrorResult));
+			}
+			ReferenceResults.Enqueue(MoveTemp(Result));
+		});
+	});
+}
+
+bool FAnimCurveToolModule::DrainReferenceResults(float DeltaTime)
+{
+	// 每帧只在时间片内写入结果，其余留到下一帧，编辑器不会因为一大批结果卡住
+	const double EndTime = FPlatformTime::Seconds() + ReferenceDrainTimeSlice;
+	ReleaseRetiredReferenceBatches();
+	TArray<UAnimSequence*> AddedAnims;
+	FReferenceAnalysisResult Result;
+	while (FPlatformTime::Seconds() < EndTime && ReferenceResults.Dequeue(Result))
+	{
+		// 已取消的批次留在队列中的结果
+		if (Result.BatchId != ReferenceBatchId.GetValue())
+		{
+			continue;
+		}
+
+		// 内容相同的动画随这一结果一起完成
+		NumPendingReferences -= 1 + Result.Duplicates.Num();
+
+		// 分析期间被删除的动画不加入基准组，领头的动画被删除时内容相同的动画仍使用这一结果
+		UAnimSequence * Anim = Result.AnimSequence;
+		TArray<UAnimSequence*> Targets;
+		if (IsValid(Anim))
+		{
+			Targets.Add(Anim);
+		}
+		for (UAnimSequence * Duplicate : Result.Duplicates)
+		{
+			if (IsValid(Duplicate))
+			{
+				Targets.Add(Duplicate);
+			}
+		}
+		if (Targets.Num() == 0)
+		{
+			continue;
+		}
+
+		// 采样失败或结果不合法时，共用这一结果的动画同样失败
+		if (!Result.Reference.IsValid() || !Result.Reference->bIsValid)
+		{
+			for (UAnimSequence * Target : Targets)
+			{
+				ReferenceFailedAnims.Add(Target->GetName());
+			}
+			continue;
+		}
+
+		const SGMarkerReference & ref = *Result.Reference;
+		const bool bLeaderFromCache = Result.bFromCache && Targets[0] == Anim;
+		if (bLeaderFromCache)
+		{
+			NumCachedReferences++;
+		}
+		if (ref.bUsedFallback)
+		{
+			ReferenceFallbackAnims.Add(Targets[0]->GetName());
+		}
+		if (ref.bFromMirror)
+		{
+			NumMirroredReferences++;
+		}
+
+		// 内容相同的动画直接复制结果，缓存恢复的动画不需要写回步态缓存
+		for (UAnimSequence * Target : Targets)
+		{
+			SGMarkerReference & Copy = ReferenceDrainGroup->Add(Target, ref);
+			Copy.AnimSequence = Target;
+			AddedAnims.Add(Target);
+			if (Target != Anim || !bLeaderFromCache)
+			{
+				ReferenceAddedAnims.Add(Target);
+			}
 		}
 	}
-	
-	// 记录所有的通知
-	for (FAnimNotifyEvent & e : RefAnimSequence->Notifies)
+
+	// 只追加新加入的动画，并刷新其它列表中这些动画的状态
+	if (AddedAnims.Num() > 0)
 	{
-		if (e.TrackIndex == TrackIndex)
+		AnimReferenceGroupPreview->AddItems(AddedAnims);
+		for (UAnimSequence* Anim : AddedAnims)
 		{
-			AllNotifies.Add(e);
+			SelectedAnimGroupPreview->RefreshStatus(Anim);
+			AnimSequencesToScalePreview->RefreshStatus(Anim);
 		}
 	}
-	
-	
-	// 将记录下的通知与标记同步
-	// 对参考动画来说，也可能获得新的标记与通知，因为它可以包含不止一个循环
-	for (auto & Anim : AnimReferenceGroup)
+
+	if (NumPendingReferences > 0)
+	{
+		return true;
+	}
+
+	// 批量计算的报告：使用了后备检测器与计算失败的动画
+	UE_LOG(LogTemp, Log, TEXT("Reference group: %d added, %d restored from gait cache, %d derived from mirrored animations, %d used fallback detector, %d failed."),
+		ReferenceAddedAnims.Num(), NumCachedReferences, NumMirroredReferences, ReferenceFallbackAnims.Num(), ReferenceFailedAnims.Num());
+	if (ReferenceFallbackAnims.Num() > 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Fallback detector used for: %s"), *FString::Join(ReferenceFallbackAnims, TEXT(", ")));
+	}
+	if (ReferenceFailedAnims.Num() > 0)
 	{
-		// 移除现存同名轨道上的所有通知与同步标记
-		Anim.Key->Notifies.RemoveAll([&](const FAnimNotifyEvent& Notify) { return Notify.TrackIndex == TrackIndex; });
-		Anim.Key->AuthoredSyncMarkers.RemoveAll([&](const FAnimSyncMarker& Marker) { return Marker.TrackIndex == TrackIndex; });
+		UE_LOG(LogTemp, Warning, TEXT("Reference calculation failed for: %s"), *FString::Join(ReferenceFailedAnims, TEXT(", ")));
+	}
+	FTrajectoryCache::Get().LogStats();
 
-		Anim.Key->RefreshCacheData();
-		
-		float RefRatio;
-		bool bOrderIsLeftRight;
-		for(FAnimSyncMarker & m : AllMarkers)
+	// 新的结果写入步态缓存，下次打开工具时直接恢复
+	if (ReferenceAddedAnims.Num() > 0)
+	{
+		TArray<const SGMarkerReference*> References;
+		for (const TPair<UAnimSequence*, SGMarkerReference> & Pair : *ReferenceDrainGroup)
 		{
-			
-			// 将时间换算为标记区间上的比例（唯一值）
-			AnimReferenceGroup[RefAnimSequence].GetRatioFromTime(m.Time, RefRatio, bOrderIsLeftRight);
+			References.Add(&Pair.Value);
+		}
+		GaitCache.Save(References, { FootLeft, FootRight });
+	}
+
+	ReferenceDrainHandle.Reset();
+	ReferenceDrainGroup = nullptr;
+	// 所有结果都已取出，工作线程不会再访问这一批的动画
+	ReferenceBatchAnims.Reset();
+	return false;
+}
+
+void FAnimCurveToolModule::CancelReferenceAnalysis()
+{
+	// 新的批次编号使工作线程跳过剩余任务，之前放入队列的结果取出时丢弃
+	ReferenceBatchId.Increment();
+	if (ReferenceDrainHandle.IsValid())
+	{
+		FTicker::GetCoreTicker().RemoveTicker(ReferenceDrainHandle);
+		ReferenceDrainHandle.Reset();
+		UE_LOG(LogTemp, Log, TEXT("Reference analysis cancelled, %d animations discarded."), NumPendingReferences);
+	}
+	ReferenceResults.Empty();
+	NumPendingReferences = 0;
+	ReferenceDrainGroup = nullptr;
+	// 正在计算的任务仍会访问这一批的动画
+	RetireReferenceBatch();
+}
+
+void FAnimCurveToolModule::RetireReferenceBatch()
+{
+	if (ReferenceAnalysisTask.IsValid() && !ReferenceAnalysisTask.IsReady())
+	{
+		FRetiredReferenceBatch & Retired = RetiredReferenceBatches.AddDefaulted_GetRef();
+		Retired.Task = MoveTemp(ReferenceAnalysisTask);
+		Retired.Anims = MoveTemp(ReferenceBatchAnims);
+	}
+	ReferenceAnalysisTask = TFuture<void>();
+	ReferenceBatchAnims.Reset();
+	ReleaseRetiredReferenceBatches();
+}
+
+void FAnimCurveToolModule::ReleaseRetiredReferenceBatches()
+{
+	RetiredReferenceBatches.RemoveAll([](const FRetiredReferenceBatch& Retired) { return Retired.Task.IsReady(); });
+}
+
+bool FAnimCurveToolModule::IsReferenceGroupReady() const
+{
+	return NumPendingReferences == 0;
+}
+
+TSharedRef<SWidget> FAnimCurveToolModule::MakeContactDetectorPicker()
+{
+	TSharedRef<SHorizontalBox> Picker = SNew(SHorizontalBox)
+		+ SHorizontalBox::Slot().AutoWidth().Padding(0, 0, 5, 0).VAlign(VAlign_Center)
+		[
+			SNew(STextBlock)
+			.Text(FText::FromString("Contact Detector"))
+		];
 
-			// 将比例换算为时间，当动画为多循环时，synctime会有多个元素
-			TArray<float> SyncTime;
-			AnimReferenceGroup[Anim.Key].GetTimeFromRatio(RefRatio, bOrderIsLeftRight, SyncTime);
-			for(float & Time : SyncTime)
+	// 每个注册的检测器一个单选框
+	for (const TSharedRef<IContactDetector> & Detector : IContactDetector::GetDetectors())
+	{
+		const FName Name = Detector->GetName();
+		Picker->AddSlot().AutoWidth().Padding(0, 0, 5, 0).VAlign(VAlign_Center)
+		[
+			SNew(SCheckBox)
+			.Style(FCoreStyle::Get(), "RadioButton")
+			.IsChecked_Lambda([this, Name]() { return ContactDetectorName == Name ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+			.OnCheckStateChanged_Lambda([this, Name](ECheckBoxState NewState) { if (NewState == ECheckBoxState::Checked) { ContactDetectorName = Name; } })
+			[
+				SNew(STextBlock)
+				.Text(FText::FromName(Name))
+			]
+		];
+	}
+
+	Picker->AddSlot().AutoWidth().Padding(10, 0, 0, 0).VAlign(VAlign_Center)
+	[
+		SNew(SCheckBox)
+		.IsChecked_Lambda([this]() { return bSubFrameRefine ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+		.OnCheckStateChanged_Lambda([this](ECheckBoxState NewState) { bSubFrameRefine = NewState == ECheckBoxState::Checked; })
+		[
+			SNew(STextBlock)
+			.Text(FText::FromString("Sub-frame"))
+		]
+	];
+
+	// 粗采样步长，大于1时只在候选窗口内采样全部帧
+	Picker->AddSlot().AutoWidth().Padding(10, 0, 5, 0).VAlign(VAlign_Center)
+	[
+		SNew(STextBlock)
+		.Text(FText::FromString("Analysis Stride"))
+	];
+	Picker->AddSlot().AutoWidth().VAlign(VAlign_Center)
+	[
+		SNew(SEditableTextBox)
+		.MinDesiredWidth(30)
+		.Text_Raw(this, &FAnimCurveToolModule::GetAnalysisStride)
+		.OnTextCommitted_Raw(this, &FAnimCurveToolModule::OnAnalysisStrideCommitted)
+	];
+	Picker->AddSlot().AutoWidth().Padding(5, 0, 0, 0).VAlign(VAlign_Center)
+	[
+		SNew(SCheckBox)
+		.IsChecked_Lambda([this]() { return bVerifyAnalysis ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+		.OnCheckStateChanged_Lambda([this](ECheckBoxState NewState) { bVerifyAnalysis = NewState == ECheckBoxState::Checked; })
+		[
+			SNew(STextBlock)
+			.Text(FText::FromString("Verify"))
+		]
+	];
+
+	// 轨迹缓存的内存预算
+	Picker->AddSlot().AutoWidth().Padding(10, 0, 5, 0).VAlign(VAlign_Center)
+	[
+		SNew(STextBlock)
+		.Text(FText::FromString("Cache Budget (MB)"))
+	];
+	Picker->AddSlot().AutoWidth().VAlign(VAlign_Center)
+	[
+		SNew(SEditableTextBox)
+		.MinDesiredWidth(40)
+		.Text_Raw(this, &FAnimCurveToolModule::GetTrajectoryCacheBudget)
+		.OnTextCommitted_Raw(this, &FAnimCurveToolModule::OnTrajectoryCacheBudgetCommitted)
+	];
+	return Picker;
+}
+
+FContactDetectorSettings FAnimCurveToolModule::MakeContactDetectorSettings() const
+{
+	FContactDetectorSettings Settings;
+	Settings.HeightTolerance = FCString::Atof(*ContactTolerance.ToString());
+	Settings.bSubFrameRefine = bSubFrameRefine;
+	Settings.AnalysisStride = FMath::Max(1, FCString::Atoi(*AnalysisStride.ToString()));
+	return Settings;
+}
+
+FText FAnimCurveToolModule::GetAnalysisStride() const
+{
+	return AnalysisStride;
+}
+
+void FAnimCurveToolModule::OnAnalysisStrideCommitted(const FText& InText, ETextCommit::Type CommitInfo)
+{
+	AnalysisStride = InText;
+}
+
+FText FAnimCurveToolModule::GetTrajectoryCacheBudget() const
+{
+	return TrajectoryCacheBudget;
+}
+
+void FAnimCurveToolModule::OnTrajectoryCacheBudgetCommitted(const FText& InText, ETextCommit::Type CommitInfo)
+{
+	TrajectoryCacheBudget = InText;
+	FTrajectoryCache::Get().SetBudget(int64(FMath::Max(0.f, FCString::Atof(*InText.ToString())) * 1024 * 1024));
+}
+
+bool FAnimCurveToolModule::GetMaxMarkerError(const SGMarkerReference& Coarse, const SGMarkerReference& Full, float& OutError)
+{
+	OutError = 0.f;
+	const TArray<float> * CoarseMarkers[4] = { &Coarse.LeftMarkers, &Coarse.RightMarkers, &Coarse.LeftLiftOffs, &Coarse.RightLiftOffs };
+	const TArray<float> * FullMarkers[4] = { &Full.LeftMarkers, &Full.RightMarkers, &Full.LeftLiftOffs, &Full.RightLiftOffs };
+	for (int32 i = 0; i < 4; i++)
+	{
+		if (CoarseMarkers[i]->Num() != FullMarkers[i]->Num())
+		{
+			return false;
+		}
+		for (int32 j = 0; j < CoarseMarkers[i]->Num(); j++)
+		{
+			OutError = FMath::Max(OutError, FMath::Abs((*CoarseMarkers[i])[j] - (*FullMarkers[i])[j]));
+		}
+	}
+	return true;
+}
+
+FReply FAnimCurveToolModule::CompareDetectorsOnClicked()
+{
+	TArray<const IContactDetector*> Detectors;
+	for (const TSharedRef<IContactDetector> & Detector : IContactDetector::GetDetectors())
+	{
+		Detectors.Add(&Detector.Get());
+	}
+
+	FContactDetectorSettings Settings = MakeContactDetectorSettings();
+	for (UAnimSequence * Anim : SelectedAnimGroup)
+	{
+		// 每个动画只采样一次，所有检测器共用同一份轨迹
+		FFootTrajectory Trajectory;
+		if (!FTrajectoryCache::Get().Find(Anim, { FootLeft, FootRight }, Trajectory))
+		{
+			if (!Trajectory.Sample(Anim, { FootLeft, FootRight }, Settings.ChunkFrames))
 			{
-				// 避免向重复的时间添加标记
-				bool ExistedAtTime = false;
-				for(auto s : Anim.Key->AuthoredSyncMarkers)
-				{
-					if (s.TrackIndex == TrackIndex)
-						ExistedAtTime |= FMath::IsNearlyEqual(s.Time, Time, 0.01f);
-				}
-				if (!ExistedAtTime)
-					AddContactMarker(Anim.Key, TrackName, m.MarkerName, Time);
+				continue;
 			}
+			FTrajectoryCache::Get().Add(Trajectory);
 		}
-		for(FAnimNotifyEvent & e : AllNotifies)
+		SGMarkerReference::GetDirectionFromName(Anim->GetName(), Settings.Dir);
+
+		TArray<FContactDetection> Detections;
+		IContactDetector::DetectAll(Trajectory, Detectors, Settings, Detections);
+		for (int32 DetectorIndex = 0; DetectorIndex < Detectors.Num(); DetectorIndex++)
 		{
-			// 将时间换算为标记区间上的比例（唯一值）
-			AnimReferenceGroup[RefAnimSequence].GetRatioFromTime(e.GetTime(), RefRatio, bOrderIsLeftRight);
-			
-			// 将比例换算为时间，当动画为多循环时，synctime会有多个元素
-			TArray<float> SyncTime;
-			AnimReferenceGroup[Anim.Key].GetTimeFromRatio(RefRatio, bOrderIsLeftRight, SyncTime);
-			for(float & Time : SyncTime)
+			for (int32 Foot = 0; Foot < 2; Foot++)
 			{
-				// 避免向重复的时间添加标记
-				bool ExistedAtTime = false;
-				for(auto n : Anim.Key->Notifies)
+				FString Times;
+				for (float Time : Detections[DetectorIndex * 2 + Foot].Contacts)
 				{
-					if (n.TrackIndex == TrackIndex)
-						ExistedAtTime |= FMath::IsNearlyEqual(n.GetTime(), Time, 0.01f);
+					Times += FString::Printf(TEXT("%.3f "), Time);
 				}
-				if (!ExistedAtTime)
-					AddAnimationNotifyEvent(Anim.Key, TrackName, Time, e.Notify->GetClass());
+				UE_LOG(LogTemp, Log, TEXT("%s %s [%s]: %s"), *Anim->GetName(), *Trajectory.BoneNames[Foot].ToString(), *Detectors[DetectorIndex]->GetName().ToString(), *Times);
 			}
-        }
-		Anim.Key->RefreshCacheData();
+		}
+	}
+	return FReply::Handled();
+}
+
+FReply FAnimCurveToolModule::SyncReferenceGroupOnClicked()
+{
+	SyncReferenceGroup(RefAnimSeuquence, RefTrackName);
+
+	return FReply::Handled();
+}
+
+void FAnimCurveToolModule::SyncReferenceGroup(UAnimSequence* RefAnimSequence, FName TrackName)
+{
+	FSyncJobSource Source;
+	Source.RefAnimSequence = RefAnimSequence;
+	Source.TrackName = TrackName;
+	RunSyncJob(TArray<FSyncJobSource>({ Source }));
+}
+
+FReply FAnimCurveToolModule::AddToSyncJobOnClicked()
+{
+	if (RefAnimSeuquence == nullptr || RefTrackName.IsNone())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Select a reference animation and enter a track name before adding to the sync job."));
+		return FReply::Handled();
+	}
+
+	FSyncJobSource Source;
+	Source.RefAnimSequence = RefAnimSeuquence;
+	Source.TrackName = RefTrackName;
+	SyncJobSources.AddUnique(Source);
+	UpdateSyncJobPreview();
+	return FReply::Handled();
+}
+
+FReply FAnimCurveToolModule::ClearSyncJobOnClicked()
+{
+	SyncJobSources.Reset();
+	UpdateSyncJobPreview();
+	return FReply::Handled();
+}
+
+FReply FAnimCurveToolModule::RunSyncJobOnClicked()
+{
+	RunSyncJob(SyncJobSources);
+	return FReply::Handled();
+}
+
+void FAnimCurveToolModule::UpdateSyncJobPreview()
+{
+	FString JobText = "Sync Job:";
+	for (const FSyncJobSource & Source : SyncJobSources)
+	{
+		JobText += FString::Printf(TEXT("\n%s <- %s"), *Source.TrackName.ToString(), *Source.RefAnimSequence->GetName());
+	}
+	if (SyncJobSources.Num() == 0)
+	{
+		JobText += " None";
+	}
+	SyncJobPreview->SetText(FText::FromString(JobText));
+}
+
+void FAnimCurveToolModule::RunSyncJob(const TArray<FSyncJobSource>& Sources)
+{
+	// 记录所有参考轨道上的同步标记与通知，全部换算为各自参考动画的区间比例
+	TArray<FSyncSourceEvent> Events;
+	TArray<FName> TrackNames;
+	for (const FSyncJobSource & Source : Sources)
+	{
+		// Sanity Check
+		const SGMarkerReference * Reference = Source.RefAnimSequence ? AnimReferenceGroup.Find(Source.RefAnimSequence) : nullptr;
+		if (Reference == nullptr)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Animation %s doesn't belong to the current reference group being processed."), Source.RefAnimSequence ? *Source.RefAnimSequence->GetName() : TEXT("None"));
+			continue;
+		}
+
+		if (FReferenceGroupSync::CollectEvents(*Reference, Source.TrackName, Events))
+		{
+			TrackNames.AddUnique(Source.TrackName);
+		}
+	}
+
+	if (TrackNames.Num() == 0)
+	{
+		return;
+	}
 
+	// 规划阶段：在工作线程上并行计算每个动画在所有轨道上最终的标记与通知
+	// 对参考动画来说，也可能获得新的标记与通知，因为它可以包含不止一个循环
+	TArray<const SGMarkerReference*> Targets;
+	Targets.Reserve(AnimReferenceGroup.Num());
+	for (const auto & Anim : AnimReferenceGroup)
+	{
+		Targets.Add(&Anim.Value);
 	}
+	TArray<FSyncTargetPlan> Plans;
+	FReferenceGroupSync::PlanTargets(Events, Targets, Plans);
 
-	return;
+	// 应用阶段：在游戏线程上依次修改资源，每个动画的所有轨道一次完成
+	for (const FSyncTargetPlan & Plan : Plans)
+	{
+		ApplySyncPlan(Plan, Events, TrackNames);
+	}
+}
+
+void FAnimCurveToolModule::ApplySyncPlan(const FSyncTargetPlan& Plan, const TArray<FSyncSourceEvent>& Events, const TArray<FName>& TrackNames)
+{
+	UAnimSequence * Anim = Plan.AnimSequence;
+	Anim->Modify();
+
+	for (const FName & TrackName : TrackNames)
+	{
+		// 移除现存同名轨道上的所有通知与同步标记，目标上没有该轨道时新建
+		const int32 TrackIndex = GetTrackIndexForAnimationNotifyTrackName(Anim, TrackName);
+		if (TrackIndex == INDEX_NONE)
+		{
+			AddAnimationNotifyTrack(Anim, TrackName, FLinearColor::White);
+			continue;
+		}
+		Anim->Notifies.RemoveAll([&](const FAnimNotifyEvent& Notify) { return Notify.TrackIndex == TrackIndex; });
+		Anim->AuthoredSyncMarkers.RemoveAll([&](const FAnimSyncMarker& Marker) { return Marker.TrackIndex == TrackIndex; });
+	}
+
+	// 批量添加，最后统一刷新一次缓存
+	for (const FSyncPlannedEvent & Marker : Plan.Markers)
+	{
+		AddAnimationSyncMarker(Anim, Events[Marker.SourceIndex].MarkerName, Marker.Time, Marker.TrackName, false);
+	}
+	for (const FSyncPlannedEvent & Notify : Plan.Notifies)
+	{
+		AddAnimationNotifyEvent(Anim, Notify.TrackName, Notify.Time, Events[Notify.SourceIndex].NotifyClass, false);
+	}
+
+	Anim->RefreshSyncMarkerDataFromAuthored();
+	Anim->RefreshCacheData();
+	Anim->MarkPackageDirty();
 }
 
 /*
@@ -1158,6 +2095,89 @@ void FAnimCurveToolModule::OnAnimToMarkPathSelected(const FString& NewPath)
 }
 */
 
+FReply FAnimCurveToolModule::BakeFootCurvesOnClicked()
+{
+	FGaitCurveSettings Settings;
+	Settings.ContactBlendTime = FMath::Max(0.f, FCString::Atof(*ContactBlendTime.ToString()));
+	Settings.LockBlendTime = FMath::Max(0.f, FCString::Atof(*LockBlendTime.ToString()));
+	const float Tolerance = GetKeyToleranceValue();
+
+	TArray<const SGMarkerReference*> References;
+	for (const TPair<UAnimSequence*, SGMarkerReference> & Pair : AnimReferenceGroup)
+	{
+		References.Add(&Pair.Value);
+	}
+
+	// 曲线只依赖缓存的步态分析结果，可以在工作线程上并行生成
+	TArray<FBakedAnimCurves> BakedAnims;
+	BakedAnims.SetNum(References.Num());
+	ParallelFor(References.Num(), [&](int32 Index)
+	{
+		FCurveBakeResult Result;
+		if (FGaitCurveBaker::MakeFootCurves(*References[Index], Settings, Result))
+		{
+			BakedAnims[Index].AnimSequence = Result.AnimSequence;
+			FCurveBaker::MakeBakedCurves(Result, Tolerance, BakedAnims[Index].Curves);
+		}
+	});
+
+	WriteBakedCurves(BakedAnims, false);
+	return FReply::Handled();
+}
+
+FReply FAnimCurveToolModule::BakePhaseCurvesOnClicked()
+{
+	const EGaitPhaseMode Mode = bPhaseHalfCycle ? EGaitPhaseMode::HalfCycle : EGaitPhaseMode::Stride;
+
+	// 相位曲线的关键帧直接由区间边界生成，不需要再精简
+	TArray<FBakedAnimCurves> BakedAnims;
+	for (const TPair<UAnimSequence*, SGMarkerReference> & Pair : AnimReferenceGroup)
+	{
+		FBakedCurve Curve;
+		if (FGaitCurveBaker::MakePhaseCurve(Pair.Value, Mode, Curve))
+		{
+			FBakedAnimCurves & Baked = BakedAnims.AddDefaulted_GetRef();
+			Baked.AnimSequence = Pair.Key;
+			Baked.Curves.Add(MoveTemp(Curve));
+		}
+	}
+
+	WriteBakedCurves(BakedAnims, false);
+	return FReply::Handled();
+}
+
+FReply FAnimCurveToolModule::BakeGaitTablesOnClicked()
+{
+	int32 NumBaked = 0;
+	for (const TPair<UAnimSequence*, SGMarkerReference> & Pair : AnimReferenceGroup)
+	{
+		UAnimSequence * Anim = Pair.Key;
+		if (!Pair.Value.bIsValid)
+		{
+			continue;
+		}
+
+		TArray<FGaitTableInterval> Intervals;
+		FGaitCurveBaker::MakeGaitTableIntervals(Pair.Value, Intervals);
+
+		// 已有步态表时直接覆盖，否则新建并挂到动画上
+		Anim->Modify();
+		UGaitTableUserData * GaitTable = Anim->GetAssetUserData<UGaitTableUserData>();
+		if (GaitTable == nullptr)
+		{
+			GaitTable = NewObject<UGaitTableUserData>(Anim, NAME_None, RF_Transactional);
+			Anim->AddAssetUserData(GaitTable);
+		}
+		GaitTable->Modify();
+		GaitTable->Initialize(Anim->GetPlayLength(), Pair.Value.LeftMarkers, Pair.Value.RightMarkers, MoveTemp(Intervals));
+		Anim->MarkPackageDirty();
+		NumBaked++;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Baked gait tables into %d animations."), NumBaked);
+	return FReply::Handled();
+}
+
 FReply FAnimCurveToolModule::AddDefaultMarkerForReferenceGroup()
 {
 	FName TrackName = FName(TEXT("Default Track"));
@@ -1204,14 +2224,11 @@ void FAnimCurveToolModule::AddContactMarker(UAnimSequence * AnimSequence, FName
 FTransform FAnimCurveToolModule::GetBoneTMRelativeToRoot(UAnimSequence* AnimationSequence, FName BoneName, int Frame)
 {
 	FTransform Transform = FTransform::Identity;
-	TArray<FName> BonePath;
-	FindBonePathToRoot(AnimationSequence, BoneName, BonePath);
-	for (FName CurBone : BonePath)
+
+	// 沿父骨骼索引直接走到根骨骼，不需要构建骨骼路径
+	const FReferenceSkeleton & RefSkeleton = AnimationSequence->GetSkeleton()->GetReferenceSkeleton();
+	for (int32 BoneIndex = RefSkeleton.FindBoneIndex(BoneName); BoneIndex != INDEX_NONE; BoneIndex = RefSkeleton.GetParentIndex(BoneIndex))
 	{
-		int32 BoneIndex = AnimationSequence->GetSkeleton()->GetReferenceSkeleton().FindBoneIndex(CurBone);
-		if (BoneIndex == INDEX_NONE)
-			continue;
-		
 		int32 TrackIndex = GetAnimTrackIndexForSkeletonBone(BoneIndex, AnimationSequence->GetRawTrackToSkeletonMapTable());
 		FTransform BoneTransform;
 
@@ -1222,13 +2239,12 @@ FTransform FAnimCurveToolModule::GetBoneTMRelativeToRoot(UAnimSequence* Animatio
 			BoneTransform.SetLocation(FVector(0, 0, 0));	
 		}
 		
-		//UE_LOG(LogTemp, Warning, TEXT("%s %d: %s"), *CurBone.ToString(), TrackIndex, *BoneTransform.ToString());
 		Transform = Transform * BoneTransform;
 	}
 	return Transform;
 }
 
-void FAnimCurveToolModule::AddAnimationSyncMarker(UAnimSequence* AnimationSequence, FName MarkerName, float Time, FName TrackName)
+void FAnimCurveToolModule::AddAnimationSyncMarker(UAnimSequence* AnimationSequence, FName MarkerName, float Time, FName TrackName, bool bRefreshCache)
 {
 	if (AnimationSequence)
 	{
@@ -1242,17 +2258,22 @@ void FAnimCurveToolModule::AddAnimationSyncMarker(UAnimSequence* AnimationSequen
 			NewMarker.TrackIndex = GetTrackIndexForAnimationNotifyTrackName(AnimationSequence, TrackName);
 
 			AnimationSequence->AuthoredSyncMarkers.Add(NewMarker);
-			AnimationSequence->AnimNotifyTracks[NewMarker.TrackIndex].SyncMarkers.Add(&AnimationSequence->AuthoredSyncMarkers.Last());
-						
-			AnimationSequence->RefreshSyncMarkerDataFromAuthored();
 
-			// Refresh all cached data
-			AnimationSequence->RefreshCacheData();
+			// 批量添加时数组可能扩容，轨道上的指针由调用方最后刷新缓存时重建
+			if (bRefreshCache)
+			{
+				AnimationSequence->AnimNotifyTracks[NewMarker.TrackIndex].SyncMarkers.Add(&AnimationSequence->AuthoredSyncMarkers.Last());
+							
+				AnimationSequence->RefreshSyncMarkerDataFromAuthored();
+
+				// Refresh all cached data
+				AnimationSequence->RefreshCacheData();
+			}
 		}
 	}
 }
 
-UAnimNotify* FAnimCurveToolModule::AddAnimationNotifyEvent(UAnimSequence* AnimationSequence, FName NotifyTrackName, float StartTime, TSubclassOf<UAnimNotify> NotifyClass)
+UAnimNotify* FAnimCurveToolModule::AddAnimationNotifyEvent(UAnimSequence* AnimationSequence, FName NotifyTrackName, float StartTime, TSubclassOf<UAnimNotify> NotifyClass, bool bRefreshCache)
 {
 	UAnimNotify* Notify = nullptr;
 	if (AnimationSequence)
@@ -1287,7 +2308,10 @@ UAnimNotify* FAnimCurveToolModule::AddAnimationNotifyEvent(UAnimSequence* Animat
 			}
 
 			// Refresh all cached data
-			AnimationSequence->RefreshCacheData();
+			if (bRefreshCache)
+			{
+				AnimationSequence->RefreshCacheData();
+			}
 		}
 	}
 
@@ -1360,30 +2384,6 @@ int32 FAnimCurveToolModule::GetTrackIndexForAnimationNotifyTrackName(const UAnim
        });
 }
 
-void FAnimCurveToolModule::FindBonePathToRoot(const UAnimSequence* AnimationSequence, FName BoneName, TArray<FName>& BonePath)
-{
-	BonePath.Empty();
-	if (AnimationSequence)
-	{
-		BonePath.Add(BoneName);
-		int32 BoneIndex = AnimationSequence->GetSkeleton()->GetReferenceSkeleton().FindRawBoneIndex(BoneName);		
-		if (BoneIndex != INDEX_NONE)
-		{
-			while (BoneIndex != INDEX_NONE)
-			{
-				const int32 ParentBoneIndex = AnimationSequence->GetSkeleton()->GetReferenceSkeleton().GetRawParentIndex(BoneIndex);
-				if (ParentBoneIndex != INDEX_NONE)
-				{
-					BonePath.Add(AnimationSequence->GetSkeleton()->GetReferenceSkeleton().GetBoneName(ParentBoneIndex));
-					//UE_LOG(LogTemp, Warning, TEXT("%s"), *AnimationSequence->GetSkeleton()->GetReferenceSkeleton().GetBoneName(ParentBoneIndex).ToString())
-				}
-
-				BoneIndex = ParentBoneIndex;
-			}
-		}
-	}
-}
-
 int32 FAnimCurveToolModule::GetAnimTrackIndexForSkeletonBone(const int32 InSkeletonBoneIndex,
 	const TArray<FTrackToSkeletonMap>& TrackToSkelMap)
 {
@@ -1394,38 +2394,21 @@ int32 FAnimCurveToolModule::GetAnimTrackIndexForSkeletonBone(const int32 InSkele
 }
 
 
-/******* Deprecated Functions for Curve Extractor *************/
-/*
-TSharedRef<SWidget> FAnimCurveToolModule::MakeCurveExtractor()
+/******* 曲线烘焙工具 *************/
+TSharedRef<SWidget> FAnimCurveToolModule::MakeCurveBaker()
 {
-	// ComboButton + AssetPicker for anim sequence
-    SAssignNew(SelectAnimSequenceButtonPtr, SComboButton)
-    .OnGetMenuContent_Raw(this, &FAnimCurveToolModule::OnGetAnimMenu)
-    .ButtonContent()
-    [
-        SNew(STextBlock)
-        .Text(FText::FromString("Choose Anim Sequence"))
-    ];
-    SAssignNew(SelectAnimSequenceWidgetPtr, SHorizontalBox)
-    + SHorizontalBox::Slot()
-    .AutoWidth()
-	[
-		SelectAnimSequenceButtonPtr.ToSharedRef()
-    ];
-
 	// Widget that allow scaling of the exported curve
 	TSharedRef<SWidget> ScalingFactorWidget =
         SNew(SVerticalBox)
         + SVerticalBox::Slot().Padding(0, 0, 0, 5)
         [
-			
             SNew(SHorizontalBox)
             + SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
             [
                 SNew(STextBlock)
                 .Text(FText::FromString("Translation Scale"))
             ]
-            + SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+            + SHorizontalBox::Slot().AutoWidth().Padding(5, 0, 0, 0).VAlign(VAlign_Center)
             [
                 SNew(SEditableTextBox)
                 .MinDesiredWidth(50)
@@ -1436,64 +2419,35 @@ TSharedRef<SWidget> FAnimCurveToolModule::MakeCurveExtractor()
         + SVerticalBox::Slot()
         [
             SNew(SHorizontalBox)
-            + SHorizontalBox::Slot()
-            .AutoWidth()
-            .VAlign(VAlign_Center)
+            + SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
             [
                 SNew(STextBlock)
                 .Text(FText::FromString("Rotation Scale"))
             ]
-            + SHorizontalBox::Slot()
-            .AutoWidth()
-            .Padding(5, 0, 0, 0)
-            .VAlign(VAlign_Center)
+            + SHorizontalBox::Slot().AutoWidth().Padding(5, 0, 0, 0).VAlign(VAlign_Center)
             [
                 SNew(SEditableTextBox)
                 .MinDesiredWidth(50)
                 .Text_Raw(this, &FAnimCurveToolModule::GetRotScale)
                 .OnTextCommitted_Raw(this, &FAnimCurveToolModule::OnRotScaleCommitted)
             ]
-        ];
-	
-	// Enter and Display bone name, Button for extracting curve
-	TSharedRef<SWidget> BoneNameWidget =
-    	SNew(SHorizontalBox)
-		+ SHorizontalBox::Slot()
-        .AutoWidth()
-        .VAlign(VAlign_Center)
-        [
-            SNew(STextBlock)
-            .Text(FText::FromString("Enter Bone Name"))
         ]
-    	+ SHorizontalBox::Slot().AutoWidth().Padding(5, 0, 0, 0).VAlign(VAlign_Center)
-    	[
-    	    SNew(SEditableTextBox)
-    	    .MinDesiredWidth(50)
-    	    .Text_Raw(this, &FAnimCurveToolModule::GetBoneName)
-    	    .OnTextCommitted_Raw(this, &FAnimCurveToolModule::OnBoneNameCommitted)
-    	];
-
-	TSharedRef<SWidget> ExtractCurveButton =
-		SNew(SHorizontalBox)
-        + SHorizontalBox::Slot()
-        .AutoWidth()
-        .VAlign(VAlign_Center)
-		[
-			SNew(SButton)
-			.Text(FText::FromString("Extract Curve"))
-			.OnClicked_Raw(this, &FAnimCurveToolModule::ExtractBoneCurve)
-		];
-		
-	
-	// Thumbnail for Anim Sequence
-	AnimThumbnailPoolPtr = MakeShared<FAssetThumbnailPool>(10, true);
-	AnimThumbnailPtr = MakeShareable(new FAssetThumbnail(FAssetData(), 128, 128, AnimThumbnailPoolPtr));
-	TSharedRef<SWidget> AnimThumbnailBox =
-    	SNew(SHorizontalBox)
-		+ SHorizontalBox::Slot().MaxWidth(128)
-		[
-			AnimThumbnailPtr->MakeThumbnailWidget()
-		];
+        + SVerticalBox::Slot().Padding(0, 5, 0, 0)
+        [
+            SNew(SHorizontalBox)
+            + SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+            [
+                SNew(STextBlock)
+                .Text(FText::FromString("Key Tolerance (0 = every frame)"))
+            ]
+            + SHorizontalBox::Slot().AutoWidth().Padding(5, 0, 0, 0).VAlign(VAlign_Center)
+            [
+                SNew(SEditableTextBox)
+                .MinDesiredWidth(50)
+                .Text_Raw(this, &FAnimCurveToolModule::GetKeyTolerance)
+                .OnTextCommitted_Raw(this, &FAnimCurveToolModule::OnKeyToleranceCommitted)
+            ]
+        ];
 
 	// A matrix of checkboxes that allow output selection
 	TSharedRef<SWidget> OutputBoxWidget =
@@ -1516,147 +2470,191 @@ TSharedRef<SWidget> FAnimCurveToolModule::MakeCurveExtractor()
 			MakeOutputCheckboxRow("Scale")
         ];
 
-	// Add widget to edit where the curves are save
+	// Add widget to edit where the curve tables are saved
 	IContentBrowserSingleton& ContentBrowser = FModuleManager::LoadModuleChecked<FContentBrowserModule>("ContentBrowser").Get();
 	FPathPickerConfig PathPickerConfig;
 	PathPickerConfig.OnPathSelected = FOnPathSelected::CreateRaw(this, &FAnimCurveToolModule::OnSavePathSelected);
 	PathPickerConfig.DefaultPath = "/Game/";
 
-	TSharedRef<SWidget> SavePathWidget =
+	TSharedRef<SWidget> CurveBaker =
 		SNew(SVerticalBox)
-		+ SVerticalBox::Slot().AutoHeight()
+		+ SVerticalBox::Slot().VAlign(VAlign_Center).Padding(15, 10, 15, 10).MaxHeight(32)
 		[
 			SNew(STextBlock)
-			.Text(FText::FromString("Output Path"))
+			.Text(FText::FromString("Bake Animation Curves"))
+			.Font(FCoreStyle::GetDefaultFontStyle("Regular", 16))
 		]
-		+ SVerticalBox::Slot().AutoHeight().Padding(0, 0, 0, 5)
+		+ SVerticalBox::Slot().AutoHeight().Padding(15, 10, 15, 0)
 		[
-			SNew(SHorizontalBox)
-			+ SHorizontalBox::Slot().MaxWidth(200)
+			SNew(STextBlock)
+			.Text(FText::FromString("Bone Names (comma separated)"))
+		]
+		+ SVerticalBox::Slot().AutoHeight().Padding(15, 0, 15, 5)
+		[
+			SNew(SEditableTextBox)
+			.MinDesiredWidth(150)
+			.Text_Raw(this, &FAnimCurveToolModule::GetBakeBoneNames)
+			.OnTextCommitted_Raw(this, &FAnimCurveToolModule::OnBakeBoneNamesCommitted)
+		]
+		+ SVerticalBox::Slot().AutoHeight().Padding(15, 0, 15, 5)
+		[
+			ScalingFactorWidget
+		]
+		+ SVerticalBox::Slot().AutoHeight().Padding(15, 0, 15, 5)
+		[
+			OutputBoxWidget
+		]
+		+ SVerticalBox::Slot().AutoHeight().Padding(15, 0, 15, 5)
+		[
+			SNew(SCheckBox)
+			.IsChecked_Lambda([this]() { return bBakeRootRelative ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+			.OnCheckStateChanged_Lambda([this](ECheckBoxState NewState) { bBakeRootRelative = NewState == ECheckBoxState::Checked; })
+			[
+				SNew(STextBlock)
+				.Text(FText::FromString("Root Relative (otherwise Local)"))
+			]
+		]
+		+ SVerticalBox::Slot().AutoHeight().Padding(15, 0, 15, 5)
+		[
+			SNew(SCheckBox)
+			.IsChecked_Lambda([this]() { return bBakeToCurveAsset ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+			.OnCheckStateChanged_Lambda([this](ECheckBoxState NewState) { bBakeToCurveAsset = NewState == ECheckBoxState::Checked; })
+			[
+				SNew(STextBlock)
+				.Text(FText::FromString("Write Curve Table Asset (otherwise into Sequence)"))
+			]
+		]
+		+ SVerticalBox::Slot().AutoHeight().Padding(15, 0, 15, 0)
+		[
+			SNew(STextBlock)
+			.Text(FText::FromString("Curve Table Output Path"))
+		]
+		+ SVerticalBox::Slot().AutoHeight().Padding(15, 0, 15, 5)
+		[
+			SNew(SBox)
+			.MaxDesiredHeight(200)
+			.WidthOverride(200)
 			[
 				ContentBrowser.CreatePathPicker(PathPickerConfig)
 			]
 		]
-		+ SVerticalBox::Slot().AutoHeight()
+		+ SVerticalBox::Slot().AutoHeight().Padding(15, 0, 15, 20)
 		[
-			ExtractCurveButton
+			SNew(SButton)
+			.Text(FText::FromString("Bake Curves for Current Group"))
+			.OnClicked_Raw(this, &FAnimCurveToolModule::BakeCurvesOnClicked)
 		];
-	
-	TSharedRef<SWidget> Extractor =
-		SNew(SVerticalBox)
-		+ SVerticalBox::Slot().VAlign(VAlign_Center).Padding(15, 10, 15, 20)
-    	  .MaxHeight(32)
-    	  [
-    	      SNew(STextBlock)
-    	      .Text(FText::FromString("Extract AnimSequence Curve"))
-    	      .Font(FCoreStyle::GetDefaultFontStyle("Regular", 16))
-    	  ]
-          + SVerticalBox::Slot().VAlign(VAlign_Center).Padding(15, 0, 15, 5).MaxHeight(32)
-          [
-              SelectAnimSequenceWidgetPtr.ToSharedRef()
-          ]
-          + SVerticalBox::Slot()
-          .AutoHeight().MaxHeight(128).VAlign(VAlign_Center).Padding(15, 0, 15, 5)
-          [
-              AnimThumbnailBox
-          ]
-          + SVerticalBox::Slot().VAlign(VAlign_Center).Padding(15, 0, 15, 5)
-          .MaxHeight(32)
-          [
-              BoneNameWidget
-          ]
-          +SVerticalBox::Slot().VAlign(VAlign_Center).Padding(15, 0, 15, 5)
-        .MaxHeight(64)
-        [
-            ScalingFactorWidget
-        ]
-        +SVerticalBox::Slot().VAlign(VAlign_Center).Padding(15, 0, 15, 5)
-        .MaxHeight(128)
-        [
-            OutputBoxWidget
-        ]
-        +SVerticalBox::Slot().VAlign(VAlign_Center).Padding(15, 0, 15, 20)
-          .MaxHeight(512)
-        [
-            SavePathWidget
-        ];
 
-	return Extractor;
+	return CurveBaker;
 }
 
-void FAnimCurveToolModule::OnAnimAssetSelected(const FAssetData& AssetData)
+FCurveBakeSettings FAnimCurveToolModule::MakeCurveBakeSettings() const
 {
-	AnimSequenceToExtract = Cast<UAnimSequence>(AssetData.GetAsset());
-	SelectAnimSequenceButtonPtr->SetIsOpen(false);
-	TSharedRef<SWidget> NewButton =
-		SNew(SComboButton)
-            .OnGetMenuContent_Raw(this, &FAnimCurveToolModule::OnGetAnimMenu)
-            .ButtonContent()
-            [
-                SNew(STextBlock)
-                .Text(FText::FromName(AssetData.AssetName))
-            ];
-	SelectAnimSequenceButtonPtr->SetContent(NewButton);
-	AnimThumbnailPtr->SetAsset(AssetData);
-	AnimThumbnailPtr->RefreshThumbnail();
-}
+	FCurveBakeSettings Settings;
+	Settings.bRootRelative = bBakeRootRelative;
+	Settings.TranslationScale = FCString::Atof(*TransScale.ToString());
+	Settings.RotationScale = FCString::Atof(*RotScale.ToString());
+	Settings.KeyTolerance = GetKeyToleranceValue();
 
-TSharedRef<SWidget> FAnimCurveToolModule::OnGetAnimMenu()
-{
-	TArray<const UClass*> ClassFilters;
-	ClassFilters.Add(UAnimSequence::StaticClass());
-	FAssetData CurrentAssetData = FAssetData();
-	
-	AnimSequencePicker = PropertyCustomizationHelpers::MakeAssetPickerWithMenu(
-    FAssetData(),
-    true,
-    ClassFilters,
-    TArray<UFactory*>(),
-    FOnShouldFilterAsset::CreateLambda([CurrentAssetData](const FAssetData& InAssetData) { return InAssetData == CurrentAssetData; }),
-    FOnAssetSelected::CreateRaw(this, &FAnimCurveToolModule::OnAnimAssetSelected),
-    FSimpleDelegate()
-    );
+	TArray<FString> BoneNames;
+	BakeBoneNames.ToString().ParseIntoArray(BoneNames, TEXT(","), true);
+
+	const TPair<FString, ECurveBakeChannel> Channels[] = {
+		TPair<FString, ECurveBakeChannel>(FString("Translation"), ECurveBakeChannel::Translation),
+		TPair<FString, ECurveBakeChannel>(FString("Rotation"), ECurveBakeChannel::Rotation),
+		TPair<FString, ECurveBakeChannel>(FString("Scale"), ECurveBakeChannel::Scale) };
+	const FString Axes[] = { FString("X"), FString("Y"), FString("Z") };
 
-	return AnimSequencePicker.ToSharedRef();
+	for (const FString & BoneName : BoneNames)
+	{
+		const FString TrimmedName = BoneName.TrimStartAndEnd();
+		if (TrimmedName.Len() == 0)
+		{
+			continue;
+		}
+		for (const TPair<FString, ECurveBakeChannel> & Channel : Channels)
+		{
+			for (int32 Axis = 0; Axis < 3; Axis++)
+			{
+				if (OutputBoxStateMap[Channel.Key + Axes[Axis]])
+				{
+					FCurveBakeRequest & Request = Settings.Requests.AddDefaulted_GetRef();
+					Request.BoneName = FName(*TrimmedName);
+					Request.Channel = Channel.Value;
+					Request.Axis = Axis;
+				}
+			}
+		}
+	}
+	return Settings;
 }
 
-bool FAnimCurveToolModule::FillCurveVector() 
+FReply FAnimCurveToolModule::BakeCurvesOnClicked()
 {
-	if(!AnimSequenceToExtract)
-		return false;
-	const int BoneIndex = AnimSequenceToExtract->GetSkeleton()->GetReferenceSkeleton().FindBoneIndex(TargetBoneName);
-	const int TrackIndex = GetAnimTrackIndexForSkeletonBone(BoneIndex, AnimSequenceToExtract->GetRawTrackToSkeletonMapTable());
-	if (BoneIndex == INDEX_NONE)
-		return false;
-
-	TransCurve.Reset();
-	RotCurve.Reset();
-	ScaleCurve.Reset();
-	
-	const float TScale = FCString::Atof(*TransScale.ToString());
-	const float RScale = FCString::Atof(*RotScale.ToString());
-	const float DeltaTime = AnimSequenceToExtract->GetPlayLength() / AnimSequenceToExtract->GetNumberOfFrames();
-	for (int i = 0; i < AnimSequenceToExtract->GetNumberOfFrames(); i++)
+	const FCurveBakeSettings Settings = MakeCurveBakeSettings();
+	if (Settings.Requests.Num() == 0)
 	{
-		FTransform Out;
-		AnimSequenceToExtract->GetBoneTransform(Out, TrackIndex , i * DeltaTime, true);
-		TransCurve.Add(Out.GetLocation() * TScale);
-		RotCurve.Add(Out.GetRotation().Euler() * RScale);
-		ScaleCurve.Add(Out.GetScale3D());
+		UE_LOG(LogTemp, Warning, TEXT("No bone or output channel selected for curve baking."));
+		return FReply::Handled();
 	}
-	return true;
+
+	// 在工作线程上并行采样所有动画，每个动画只遍历一次所有帧
+	TArray<FCurveBakeResult> Results;
+	FCurveBaker::SampleSequences(SelectedAnimGroup.GetArray(), Settings, Results);
+
+	TArray<FBakedAnimCurves> BakedAnims;
+	BakedAnims.SetNum(Results.Num());
+	ParallelFor(Results.Num(), [&](int32 Index)
+	{
+		if (Results[Index].bIsValid)
+		{
+			BakedAnims[Index].AnimSequence = Results[Index].AnimSequence;
+			FCurveBaker::MakeBakedCurves(Results[Index], Settings.KeyTolerance, BakedAnims[Index].Curves);
+		}
+	});
+
+	WriteBakedCurves(BakedAnims, bBakeToCurveAsset);
+	return FReply::Handled();
+}
+
+float FAnimCurveToolModule::GetKeyToleranceValue() const
+{
+	return FMath::Max(0.f, FCString::Atof(*KeyTolerance.ToString()));
 }
 
-void FAnimCurveToolModule::SaveCurve()
+void FAnimCurveToolModule::WriteBakedCurves(const TArray<FBakedAnimCurves>& BakedAnims, bool bToCurveAsset)
 {
-	for (const TPair<FString, bool> & pair : OutputBoxStateMap)
+	// 资源修改必须在游戏线程上进行，曲线表资源最后统一保存一次
+	TArray<UPackage*> PackagesToSave;
+	int32 NumCurves = 0;
+	for (const FBakedAnimCurves & Baked : BakedAnims)
 	{
-		if (pair.Value)
+		if (Baked.AnimSequence == nullptr || Baked.Curves.Num() == 0)
+		{
+			continue;
+		}
+
+		if (bToCurveAsset)
+		{
+			if (UPackage * Package = FCurveBaker::WriteCurveTableAsset(Baked.AnimSequence, Baked.Curves, SavePath))
+			{
+				PackagesToSave.Add(Package);
+			}
+		}
+		else
 		{
-			FString str = pair.Key;
-			SaveCurveFloat(str.LeftChop(1), str.RightChop(str.Len()-1));
+			FCurveBaker::WriteAnimationCurves(Baked.AnimSequence, Baked.Curves);
 		}
+		NumCurves += Baked.Curves.Num();
+	}
+
+	if (PackagesToSave.Num() > 0)
+	{
+		UEditorLoadingAndSavingUtils::SavePackages(PackagesToSave, false);
 	}
+
+	UE_LOG(LogTemp, Log, TEXT("Baked %d curves into %d animations."), NumCurves, BakedAnims.Num());
+	FCurveBaker::LogCompression(BakedAnims);
 }
 
 TSharedRef<SWidget> FAnimCurveToolModule::MakeOutputCheckbox(FString Type, FString Axis)
@@ -1710,81 +2708,12 @@ void FAnimCurveToolModule::OnOutputCheckboxChanged(ECheckBoxState NewState, FStr
 	else
 	{
 		// When the "All Box" is checked, set all the other boxes
-		if (NewState == ECheckBoxState::Checked)
-		{
-			OutputBoxStateMap[Type+"All"] = true;
-			OutputBoxStateMap[Type+"X"] = true;
-			OutputBoxStateMap[Type+"Y"] = true;
-			OutputBoxStateMap[Type+"Z"] = true;
-		}
-		else
-		{
-			OutputBoxStateMap[Type+"All"] = false;
-			OutputBoxStateMap[Type+"X"] = false;
-			OutputBoxStateMap[Type+"Y"] = false;
-			OutputBoxStateMap[Type+"Z"] = false;
-		}
-	}
-}
-
-void FAnimCurveToolModule::SaveCurveFloat(FString Type, FString Axis) const
-{
-	if (Axis == "All")
-		return;
-	
-	TArray<FVector> TargetCurve;
-	int TargetAxis;
-	if (Type == "Translation")
-	{
-		TargetCurve = TransCurve;
-	}
-	else if (Type == "Rotation")
-	{
-		TargetCurve = RotCurve;
-	}
-	else if (Type == "Scale")
-	{
-		TargetCurve = ScaleCurve;
-	}
-	
-	if (TargetCurve.Num() == 0)
-		return;
-	
-	if (Axis == "X")
-	{
-		TargetAxis = 0;
-	}
-	else if (Axis == "Y")
-	{
-		TargetAxis = 1;
-	}
-	else
-	{
-		TargetAxis = 2;
-	}
-
-	// Organize Package
-	FString PackageName = SavePath;
-	// It seems that without the "/XXX" in the end, the file can't be saved in the corresponding folder correctly
-	const FString AnimName = AnimSequenceToExtract->GetName();
-	const FString BoneID = TargetBoneName.ToString();
-	const FString CurveName = AnimName + "_" + BoneID + "_" + Type + Axis;
-	PackageName += "/" + AnimName + "/" + CurveName;
-	UPackage* Package = CreatePackage(*PackageName);
-	Package->FullyLoad();
-	UCurveFloat* Curve = NewObject<UCurveFloat>(Package, *(CurveName), RF_Public | RF_Standalone | RF_MarkAsRootSet);
-	const float DeltaTime = AnimSequenceToExtract->GetPlayLength() / AnimSequenceToExtract->GetNumberOfFrames();
-
-	// Actually copy the data into the asset
-	for (int i = 0; i < AnimSequenceToExtract->GetNumberOfFrames(); i++)
-	{
-		Curve->FloatCurve.AddKey(i * DeltaTime, TargetCurve[i][TargetAxis]);
+		const bool bChecked = NewState == ECheckBoxState::Checked;
+		OutputBoxStateMap[Type+"All"] = bChecked;
+		OutputBoxStateMap[Type+"X"] = bChecked;
+		OutputBoxStateMap[Type+"Y"] = bChecked;
+		OutputBoxStateMap[Type+"Z"] = bChecked;
 	}
-
-	Package->MarkPackageDirty();
-	FAssetRegistryModule::AssetCreated(Curve);
-	const FString PackageFileName = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
-	UPackage::SavePackage(Package, Curve, EObjectFlags::RF_Public | EObjectFlags::RF_Standalone, *PackageFileName, GError, nullptr, true, true, SAVE_NoError);
 }
 
 TSharedRef<SWidget> FAnimCurveToolModule::MakeOutputCheckboxRow(FString Type)
@@ -1824,241 +2753,50 @@ TSharedRef<SWidget> FAnimCurveToolModule::MakeOutputCheckboxRow(FString Type)
             ];
 }
 
-
-
-void FAnimCurveToolModule::OnBoneNameCommitted(const FText& InText, ETextCommit::Type CommitInfo)
-{
-const FString str = InText.ToString();
-TargetBoneName = FName(*str.TrimStartAndEnd());
-}
-
-void FAnimCurveToolModule::OnTransScaleCommitted(const FText& InText, ETextCommit::Type CommitInfo)
-{
-TransScale = InText;
-}
-
-void FAnimCurveToolModule::OnRotScaleCommitted(const FText& InText, ETextCommit::Type CommitInfo)
+void FAnimCurveToolModule::OnSavePathSelected(const FString& NewPath)
 {
-RotScale = InText;
+	SavePath = NewPath;
 }
 
-
-
-
-FReply FAnimCurveToolModule::ExtractBoneCurve()
+FText FAnimCurveToolModule::GetBakeBoneNames() const
 {
-if (FillCurveVector())
-SaveCurve();
-return FReply::Handled();
+	return BakeBoneNames;
 }
 
-FText FAnimCurveToolModule::GetBoneName() const
+void FAnimCurveToolModule::OnBakeBoneNamesCommitted(const FText& InText, ETextCommit::Type CommitInfo)
 {
-return FText::FromName(TargetBoneName);
+	BakeBoneNames = InText;
 }
 
 FText FAnimCurveToolModule::GetTransScale() const
 {
-return TransScale;
-}
-
-FText FAnimCurveToolModule::GetRotScale() const
-{
-return RotScale;
-}
-*/
-
-/******* 不同同步组计算方案的废弃函数 *************/
-/*
-TArray<float> SGMarkerReference::GetContactTime(UAnimSequence* AnimationSequence, FName BoneName, float Threshold)
-{
-	UE_LOG(LogTemp, Warning, TEXT("%s"), *BoneName.ToString());
-	
-	TArray<FName> BonePath;
-	float MarkerTime = 0;
-	float DeltaTime = AnimationSequence->GetPlayLength() / AnimationSequence->GetNumberOfFrames();
-	int LastFrame = AnimationSequence->GetNumberOfFrames() - 1;
-	FTransform Transform;
-	float MinHeight = FAnimCurveToolModule::GetBoneTMRelativeToRoot(AnimationSequence, BoneName, LastFrame).GetLocation().Z;
-	float MinHeightTime = 0;
-
-	// 第一次遍历，找到最低点
-	for (int i = 0; i < AnimationSequence->GetNumberOfFrames(); i++)
-	{
-		Transform = FAnimCurveToolModule::GetBoneTMRelativeToRoot(AnimationSequence, BoneName, i);
-		//UE_LOG(LogTemp, Warning, TEXT("%s"), *Transform.ToString());
-		if (Transform.GetLocation().Z < MinHeight)
-		{
-			MinHeight = Transform.GetLocation().Z;
-		}
-	}
-
-	Threshold = MinHeight + Tolerance;
-	UE_LOG(LogTemp, Warning, TEXT("%s Threshold: %f"), *AnimationSequence->GetName() ,Threshold);
-
-	int StartCount = 0;
-	// 如果动画的结束帧处在threshold以下，找到这一触地区间的开始点的前一帧
-	if (FAnimCurveToolModule::GetBoneTMRelativeToRoot(AnimationSequence, BoneName, LastFrame).GetLocation().Z < Threshold)
-	{
-		FTransform StartTrans;
-		StartCount = AnimationSequence->GetNumberOfFrames();
-		do
-		{
-			StartCount --;
-			StartTrans = FAnimCurveToolModule::GetBoneTMRelativeToRoot(AnimationSequence, BoneName, StartCount);
-			//UE_LOG(LogTemp, Warning, TEXT("%s"), *StartTrans.ToString());
-		}
-		while(StartCount >= 0 && StartTrans.GetLocation().Z < Threshold);
-	}
-	
-	// 第二次遍历，用滑动窗口计算触地过程中的总位移，并结合动画方向判断该触地区间是否有效
-	float CumulativeDist = 0;
-	int Contact;
-
-	TArray<float> Result;
-	for (int i = 0; i < AnimationSequence->GetNumberOfFrames(); i++)
-	{
-		int index = (i + StartCount) % AnimationSequence->GetNumberOfFrames();
-		// 触地中，计算累积位移
-		if (FAnimCurveToolModule::GetBoneTMRelativeToRoot(AnimationSequence, BoneName, index).GetLocation().Z < Threshold)
-		{
-			if (CumulativeDist == 0)
-			{
-				Contact = index;
-			}
-			CumulativeDist += GetDisplacementAtFrame(index, BoneName);
-			UE_LOG(LogTemp, Warning, TEXT("%d Distance: %f"), i, CumulativeDist);
-		}
-		// 当区间结束时，判断累计位移是否与动画移动方向吻合
-		else
-		{
-			if (IsCumulativeDistanceValid(CumulativeDist))
-			{
-				Result.Add(AnimSequence->GetTimeAtFrame(Contact));
-				UE_LOG(LogTemp, Warning, TEXT("Valid Contact found: Start: %d  End: %d  Distance: %f"), Contact, index, CumulativeDist);
-			}
-			CumulativeDist = 0;
-			Contact = index;
-		}
-	}
-
-	if (Result.Num() == 0)
-		UE_LOG(LogTemp, Warning, TEXT("No Contact Point Found for %s %s"), *AnimationSequence->GetName(), *BoneName.ToString());
-	return Result;
+	return TransScale;
 }
 
-float SGMarkerReference::GetDisplacementAtFrame(int frame, FName BoneName)
+void FAnimCurveToolModule::OnTransScaleCommitted(const FText& InText, ETextCommit::Type CommitInfo)
 {
-	int LastFrame = frame - 1;
-	if (frame == 0)
-	{
-		LastFrame = AnimSequence->GetNumberOfFrames()-1;
-	}
-
-	const FVector v1 = FAnimCurveToolModule::GetBoneTMRelativeToRoot(AnimSequence, BoneName, frame).GetLocation();
-	//UE_LOG(LogTemp, Warning, TEXT("%s"), *v1.ToString());
-	const FVector v2 = FAnimCurveToolModule::GetBoneTMRelativeToRoot(AnimSequence, BoneName, LastFrame).GetLocation();
-
-	// 计算位移
-	if(Dir == Direction::r || Dir == Direction::l)
-	{
-		return v1.X - v2.X;
-	}
-	else
-	{
-		return v1.Y - v2.Y;
-	}
+	TransScale = InText;
 }
 
-bool SGMarkerReference::IsCumulativeDistanceValid(float Distance)
+FText FAnimCurveToolModule::GetRotScale() const
 {
-	// 积累位移需要与移动方向相反
-	if (Dir == Direction::f || Dir == Direction::rf || Dir == Direction::lf)
-	{
-		return Distance < 0;
-	}
-	else if (Dir == Direction::b || Dir == Direction::rb || Dir == Direction::lb)
-	{
-		return Distance > 0;
-	}
-	else if (Dir == Direction::r)
-	{
-		return Distance > 0;
-	}
-	else
-	{
-		return Distance < 0;
-	}
+	return RotScale;
 }
 
-float SGMarkerReference::CalculateThreshold(FName BoneName)
+void FAnimCurveToolModule::OnRotScaleCommitted(const FText& InText, ETextCommit::Type CommitInfo)
 {
-	float ratio = 0.25;
-	TArray<float> HeightArray;
-	for (int i = 0; i < AnimSequence->GetNumberOfFrames(); i++)
-	{
-		HeightArray.Add(FAnimCurveToolModule::GetBoneTMRelativeToRoot(AnimSequence, BoneName, i).GetLocation().Z);
-	}
-	HeightArray.Sort();
-	return HeightArray[(int)(HeightArray.Num() * ratio)];
+	RotScale = InText;
 }
 
-
-TArray<float> SGMarkerReference::GetCrossingTime(UAnimSequence * AnimationSequence, FName BoneName)
+FText FAnimCurveToolModule::GetKeyTolerance() const
 {
-	TArray<FName> BonePath;
-	FAnimCurveToolModule::FindBonePathToRoot(AnimationSequence, BoneName, BonePath);
-	float MarkerTime = 0;
-	float DeltaTime = AnimationSequence->GetPlayLength() / AnimationSequence->GetNumberOfFrames();
-	FTransform Transform, OldTransform;
-	bool IsOutsideContact = false;
-	FAnimCurveToolModule::GetBoneTMRelativeToRoot(AnimationSequence, BonePath, OldTransform, AnimationSequence->GetNumberOfFrames()-1);
-	//int debug;
-
-	TArray<float> Result;
-	FAnimCurveToolModule::GetBoneTMRelativeToRoot(AnimationSequence, BonePath, OldTransform, AnimationSequence->GetNumberOfFrames()-1);
-	for (int i = 0; i < AnimationSequence->GetNumberOfFrames(); i++)
-	{
-		FAnimCurveToolModule::GetBoneTMRelativeToRoot(AnimationSequence, BonePath, Transform, i);
-		if (IsCrossingPoint(Transform, OldTransform, Dir))
-		{
-			Result.Add(AnimationSequence->GetTimeAtFrame(i));
-		}
-		OldTransform = Transform;
-	}
-
-	if (Result.Num() == 0)
-		UE_LOG(LogTemp, Warning, TEXT("No Crossing Point Found for %s %s"), *AnimationSequence->GetName(), *BoneName.ToString());
-	return Result;
-	
+	return KeyTolerance;
 }
 
-bool SGMarkerReference::IsCrossingPoint(FTransform Transform, FTransform OldTransform, Direction Direction)
-{
-const FVector v1 = Transform.GetLocation();
-const FVector v2 = OldTransform.GetLocation();
-
-// 根据方向判断当前帧是否为脚部骨骼越过根骨骼的时刻
-if (Direction == Direction::f || Direction == Direction::rf || Direction == Direction::lf)
-{
-return v1.Y > 0 && v2.Y < 0;
-}
-else if (Direction == Direction::b || Direction == Direction::rb || Direction == Direction::lb)
+void FAnimCurveToolModule::OnKeyToleranceCommitted(const FText& InText, ETextCommit::Type CommitInfo)
 {
-return v1.Y < 0 && v2.Y > 0;
+	KeyTolerance = InText;
 }
-else if (Direction == Direction::r)
-{
-return v1.X < 0 && v2.X > 0;
-}
-else
-{
-return v1.X > 0 && v2.X < 0;
-}
-}
-*/
-
-
 
 
 #undef LOCTEXT_NAMESPACE
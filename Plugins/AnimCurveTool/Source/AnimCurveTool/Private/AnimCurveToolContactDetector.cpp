@@ -0,0 +1,760 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "AnimCurveToolContactDetector.h"
+
+#include "AnimCurveToolTrajectoryCache.h"
+#include "Algo/BinarySearch.h"
+#include "Async/ParallelFor.h"
+#include "Misc/MemStack.h"
+
+bool FFootTrajectory::Sample(UAnimSequence* InAnimSequence, const TArray<FName>& InBoneNames, int32 ChunkFrames)
+{
+	AnimSequence = InAnimSequence;
+	BoneNames = InBoneNames;
+
+	// 复用曲线烘焙的采样：相对根骨骼的位移，每只脚三条曲线，骨骼链上的变换每帧只计算一次
+	const FCurveBakeSettings Settings = MakeBakeSettings(BoneNames, ChunkFrames);
+	return FCurveBaker::SampleSequence(AnimSequence, Settings, Samples) && Samples.CurveNames.Num() == Settings.Requests.Num();
+}
+
+bool FFootTrajectory::SampleCoarseToFine(UAnimSequence* InAnimSequence, const TArray<FName>& InBoneNames, const IContactDetector& Detector, const FContactDetectorSettings& Settings)
+{
+	const int32 Stride = Settings.AnalysisStride;
+	if (Stride <= 1)
+	{
+		return Sample(InAnimSequence, InBoneNames, Settings.ChunkFrames);
+	}
+
+	AnimSequence = InAnimSequence;
+	BoneNames = InBoneNames;
+
+	const FCurveBakeSettings BakeSettings = MakeBakeSettings(BoneNames);
+	FBoneChainSampler Sampler;
+	if (!Sampler.Initialize(AnimSequence, BakeSettings, Samples) || Samples.CurveNames.Num() != BakeSettings.Requests.Num())
+	{
+		return false;
+	}
+
+	// 标记与帧列表只在本次采样中使用，从当前线程的临时内存栈分配
+	FMemMark Mark(FMemStack::Get());
+	const int32 NumFrames = Samples.NumFrames;
+	const int32 NumCurves = Samples.CurveNames.Num();
+	TArray<bool, TMemStackAllocator<>> Sampled;
+	Sampled.SetNumZeroed(NumFrames);
+	auto SampleFrame = [&](int32 Frame)
+	{
+		if (!Sampled[Frame])
+		{
+			Sampler.SampleFrame(Frame);
+			Sampled[Frame] = true;
+		}
+	};
+
+	// 粗采样：每Stride帧一帧，并保留最后一帧，使粗采样的首尾与原动画一样为同一姿势
+	TArray<int32, TMemStackAllocator<>> CoarseFrames;
+	CoarseFrames.Reserve(NumFrames / Stride + 2);
+	for (int32 Frame = 0; Frame < NumFrames; Frame += Stride)
+	{
+		CoarseFrames.Add(Frame);
+	}
+	if (CoarseFrames.Last() != NumFrames - 1)
+	{
+		CoarseFrames.Add(NumFrames - 1);
+	}
+	for (int32 Frame : CoarseFrames)
+	{
+		SampleFrame(Frame);
+	}
+
+	// 粗采样的轨迹，检测器按普通轨迹处理
+	FFootTrajectory Coarse;
+	Coarse.AnimSequence = AnimSequence;
+	Coarse.BoneNames = BoneNames;
+	Coarse.Samples.AnimSequence = AnimSequence;
+	Coarse.Samples.CurveNames = Samples.CurveNames;
+	Coarse.Samples.NumFrames = CoarseFrames.Num();
+	Coarse.Samples.Values.SetNumUninitialized(CoarseFrames.Num() * NumCurves);
+	for (int32 i = 0; i < CoarseFrames.Num(); i++)
+	{
+		Coarse.Samples.Times.Add(Samples.Times[CoarseFrames[i]]);
+		for (int32 Curve = 0; Curve < NumCurves; Curve++)
+		{
+			Coarse.Samples.Values[Curve * CoarseFrames.Num() + i] = Samples.Values[Curve * NumFrames + CoarseFrames[i]];
+		}
+	}
+	Coarse.Samples.bIsValid = true;
+
+	FContactDetectorSettings CoarseSettings = Settings;
+	CoarseSettings.bSubFrameRefine = false;
+	CoarseSettings.MaxSearchFrames = FMath::Max(1, Settings.MaxSearchFrames / Stride);
+	// 粗采样上每一步跨越Stride帧，每步的下降幅度约为逐帧的Stride倍
+	CoarseSettings.TurningDescentThreshold = Settings.TurningDescentThreshold * Stride;
+
+	// 粗采样上检测到的事件附近为候选窗口，失败时退回全部帧
+	bool bSampleAll = CoarseFrames.Num() < 4;
+	const float FrameTime = NumFrames > 1 ? Samples.Times[1] - Samples.Times[0] : 0.f;
+	const int32 Margin = Stride * FMath::Max(1, Settings.RefineWindowStrides);
+	FContactDetection Detection;
+	for (int32 Foot = 0; Foot < BoneNames.Num() && !bSampleAll; Foot++)
+	{
+		Detector.Detect(Coarse, Foot, CoarseSettings, Detection);
+		if (Detection.bAborted || FrameTime <= 0.f)
+		{
+			bSampleAll = true;
+			break;
+		}
+
+		auto SampleWindow = [&](int32 First, int32 Last)
+		{
+			for (int32 Frame = First - Margin; Frame <= Last + Margin; Frame++)
+			{
+				// 最后一帧与第一帧为同一姿势，窗口按循环折回
+				SampleFrame((Frame % (NumFrames - 1) + (NumFrames - 1)) % (NumFrames - 1));
+			}
+		};
+
+		for (const TArray<float> * Events : { &Detection.Contacts, &Detection.LiftOffs })
+		{
+			for (float Time : *Events)
+			{
+				const int32 Center = FMath::RoundToInt(Time / FrameTime);
+				SampleWindow(Center, Center);
+			}
+		}
+
+		// 全帧率的稳定低点从转折点开始向后搜索，转折点到其后的落地点之间也需要全部帧
+		const float Length = Samples.Times[NumFrames - 1];
+		for (float Time : Detection.TurningPoints)
+		{
+			const int32 Turning = FMath::RoundToInt(Time / FrameTime);
+			int32 Contact = Turning;
+			if (Detection.Contacts.Num() > 0)
+			{
+				const int32 Next = Algo::LowerBound(Detection.Contacts, Time);
+				const float ContactTime = Next < Detection.Contacts.Num() ? Detection.Contacts[Next] : Detection.Contacts[0] + Length;
+				const int32 Span = FMath::RoundToInt((ContactTime - Time) / FrameTime);
+				if (Span <= Settings.MaxSearchFrames + Margin)
+				{
+					Contact = Turning + Span;
+				}
+			}
+			SampleWindow(Turning, Contact);
+		}
+	}
+
+	int32 NumSampled = 0;
+	if (bSampleAll)
+	{
+		for (int32 Frame = 0; Frame < NumFrames; Frame++)
+		{
+			SampleFrame(Frame);
+		}
+		NumSampled = NumFrames;
+	}
+	else
+	{
+		// 窗口之外的帧由前后两个已采样的帧线性插值，第一帧与最后一帧一定已采样
+		int32 Last = 0;
+		for (int32 Frame = 1; Frame < NumFrames; Frame++)
+		{
+			if (!Sampled[Frame])
+			{
+				continue;
+			}
+			for (int32 Gap = Last + 1; Gap < Frame; Gap++)
+			{
+				const float Alpha = float(Gap - Last) / float(Frame - Last);
+				for (int32 Curve = 0; Curve < NumCurves; Curve++)
+				{
+					float * Values = Samples.Values.GetData() + Curve * NumFrames;
+					Values[Gap] = FMath::Lerp(Values[Last], Values[Frame], Alpha);
+				}
+			}
+			Last = Frame;
+		}
+
+		for (bool bSampled : Sampled)
+		{
+			NumSampled += bSampled ? 1 : 0;
+		}
+	}
+
+	UE_LOG(LogTemp, Verbose, TEXT("%s: coarse-to-fine analysis sampled %d of %d frames (stride %d)."), *AnimSequence->GetName(), NumSampled, NumFrames, Stride);
+	return true;
+}
+
+bool FFootTrajectory::IsMirrorPair(UAnimSequence* A, const TArray<FName>& InBoneNames, UAnimSequence* B, const TArray<FName>& MirrorBoneNames, int32 NumProbes, float Tolerance)
+{
+	const int32 NumFrames = A->GetNumberOfFrames();
+	if (B->GetNumberOfFrames() != NumFrames || InBoneNames.Num() != MirrorBoneNames.Num() || NumFrames < 2)
+	{
+		return false;
+	}
+
+	// 均匀分布的探测帧
+	TArray<int32, TInlineAllocator<16>> Probes;
+	const int32 NumProbeFrames = FMath::Clamp(NumProbes, 1, NumFrames);
+	for (int32 i = 0; i < NumProbeFrames; i++)
+	{
+		Probes.Add(i * (NumFrames - 1) / FMath::Max(1, NumProbeFrames - 1));
+	}
+
+	// 优先使用缓存中的完整轨迹，否则只采样探测帧，结果与完整采样的布局相同
+	auto GetProbeSamples = [&Probes](UAnimSequence* Anim, const TArray<FName>& Bones, FFootTrajectory& OutTrajectory)
+	{
+		if (FTrajectoryCache::Get().Find(Anim, Bones, OutTrajectory))
+		{
+			return true;
+		}
+		OutTrajectory.AnimSequence = Anim;
+		OutTrajectory.BoneNames = Bones;
+		const FCurveBakeSettings Settings = MakeBakeSettings(Bones);
+		FBoneChainSampler Sampler;
+		if (!Sampler.Initialize(Anim, Settings, OutTrajectory.Samples) || OutTrajectory.Samples.CurveNames.Num() != Settings.Requests.Num())
+		{
+			return false;
+		}
+		for (int32 Frame : Probes)
+		{
+			Sampler.SampleFrame(Frame);
+		}
+		return true;
+	};
+
+	FFootTrajectory SourceProbes, MirrorProbes;
+	if (!GetProbeSamples(A, InBoneNames, SourceProbes) || !GetProbeSamples(B, MirrorBoneNames, MirrorProbes))
+	{
+		return false;
+	}
+
+	for (int32 Foot = 0; Foot < InBoneNames.Num(); Foot++)
+	{
+		for (int32 Frame : Probes)
+		{
+			FVector Mirrored = MirrorProbes.GetLocation(Foot, Frame);
+			Mirrored.X = -Mirrored.X;
+			if (!SourceProbes.GetLocation(Foot, Frame).Equals(Mirrored, Tolerance))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+FCurveBakeSettings FFootTrajectory::MakeBakeSettings(const TArray<FName>& InBoneNames, int32 ChunkFrames)
+{
+	FCurveBakeSettings Settings;
+	Settings.bRootRelative = true;
+	Settings.ChunkFrames = ChunkFrames;
+	for (FName BoneName : InBoneNames)
+	{
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			FCurveBakeRequest & Request = Settings.Requests.AddDefaulted_GetRef();
+			Request.BoneName = BoneName;
+			Request.Channel = ECurveBakeChannel::Translation;
+			Request.Axis = Axis;
+		}
+	}
+	return Settings;
+}
+
+FVector FFootTrajectory::GetLocation(int32 Foot, int32 Frame) const
+{
+	return FVector(GetAxis(Foot, 0)[Frame], GetAxis(Foot, 1)[Frame], GetAxis(Foot, 2)[Frame]);
+}
+
+float FSubFrameRefiner::GetExtremumOffset(float Prev, float Cur, float Next)
+{
+	const float A = 0.5f * (Prev + Next) - Cur;
+	const float B = 0.5f * (Next - Prev);
+	if (FMath::Abs(A) < SMALL_NUMBER)
+	{
+		return 0.f;
+	}
+	return FMath::Clamp(-B / (2.f * A), -0.5f, 0.5f);
+}
+
+float FSubFrameRefiner::GetCrossingOffset(float Prev, float Cur, float Next, float Threshold)
+{
+	// 线性插值的结果，同时用于在二次方程的两个解中选择
+	const float Delta = Cur - Prev;
+	const float Linear = FMath::Abs(Delta) < SMALL_NUMBER ? 0.f : FMath::Clamp(-1.f + (Threshold - Prev) / Delta, -1.f, 0.f);
+
+	const float A = 0.5f * (Prev + Next) - Cur;
+	const float B = 0.5f * (Next - Prev);
+	const float C = Cur - Threshold;
+	if (FMath::Abs(A) < SMALL_NUMBER)
+	{
+		return Linear;
+	}
+
+	const float Discriminant = B * B - 4.f * A * C;
+	if (Discriminant < 0.f)
+	{
+		return Linear;
+	}
+
+	const float Root = FMath::Sqrt(Discriminant);
+	const float Roots[2] = { (-B - Root) / (2.f * A), (-B + Root) / (2.f * A) };
+	float Result = Linear;
+	float BestDistance = MAX_flt;
+	for (float X : Roots)
+	{
+		if (X >= -1.f && X <= 0.f && FMath::Abs(X - Linear) < BestDistance)
+		{
+			Result = X;
+			BestDistance = FMath::Abs(X - Linear);
+		}
+	}
+	return Result;
+}
+
+float FSubFrameRefiner::GetTime(const FFootTrajectory& Trajectory, int32 Frame, float Offset)
+{
+	const int32 NumFrames = Trajectory.GetNumFrames();
+	const float Length = Trajectory.GetTime(NumFrames - 1);
+	const float FrameTime = NumFrames > 1 ? Trajectory.GetTime(1) - Trajectory.GetTime(0) : 0.f;
+
+	float Time = Trajectory.GetTime(Frame) + Offset * FrameTime;
+	if (Time < 0.f)
+	{
+		Time += Length;
+	}
+	else if (Time >= Length && Length > 0.f)
+	{
+		Time -= Length;
+	}
+	return Time;
+}
+
+const TArray<TSharedRef<IContactDetector>>& IContactDetector::GetDetectors()
+{
+	static const TArray<TSharedRef<IContactDetector>> Detectors = {
+		MakeShared<FTurningContactDetector>(),
+		MakeShared<FHeightContactDetector>(),
+		MakeShared<FCrossingContactDetector>(),
+		MakeShared<FVelocityContactDetector>() };
+	return Detectors;
+}
+
+const IContactDetector* IContactDetector::FindDetector(FName Name)
+{
+	for (const TSharedRef<IContactDetector> & Detector : GetDetectors())
+	{
+		if (Detector->GetName() == Name)
+		{
+			return &Detector.Get();
+		}
+	}
+	return nullptr;
+}
+
+void IContactDetector::DetectAll(const FFootTrajectory& Trajectory, TArrayView<const IContactDetector* const> Detectors, const FContactDetectorSettings& Settings, TArray<FContactDetection>& OutDetections)
+{
+	const int32 NumFeet = Trajectory.BoneNames.Num();
+	OutDetections.Reset();
+	OutDetections.SetNum(Detectors.Num() * NumFeet);
+	for (int32 DetectorIndex = 0; DetectorIndex < Detectors.Num(); DetectorIndex++)
+	{
+		for (int32 Foot = 0; Foot < NumFeet; Foot++)
+		{
+			Detectors[DetectorIndex]->Detect(Trajectory, Foot, Settings, OutDetections[DetectorIndex * NumFeet + Foot]);
+		}
+	}
+}
+
+float IContactDetector::GetMoveAxisValue(const FVector& Location, Direction Dir)
+{
+	return (Dir == Direction::r || Dir == Direction::l) ? Location.X : Location.Y;
+}
+
+void FTurningContactDetector::Detect(const FFootTrajectory& Trajectory, int32 Foot, const FContactDetectorSettings& Settings, FContactDetection& OutDetection) const
+{
+	OutDetection.Contacts.Reset();
+	OutDetection.LiftOffs.Reset();
+	OutDetection.TurningPoints.Reset();
+	OutDetection.bAborted = false;
+
+	// 循环动画的最后一帧与第一帧相同，不参与检测
+	const int32 NumFrame = Trajectory.GetNumFrames() - 1;
+	const int32 ChunkFrames = FMath::Max(1, Settings.ChunkFrames > 0 ? Settings.ChunkFrames : NumFrame);
+	const int32 NumChunks = FMath::DivideAndRoundUp(FMath::Max(NumFrame, 0), ChunkFrames);
+
+	TArray<FContactDetection> ChunkDetections;
+	ChunkDetections.SetNum(NumChunks);
+	ParallelFor(NumChunks, [&](int32 Chunk)
+	{
+		DetectRange(Trajectory, Foot, Settings, Chunk * ChunkFrames, FMath::Min(NumFrame, (Chunk + 1) * ChunkFrames), ChunkDetections[Chunk]);
+	}, NumChunks <= 1);
+
+	// 按块的顺序拼接，跨越循环点的落地时间在排序时回到开头
+	for (const FContactDetection & Chunk : ChunkDetections)
+	{
+		if (Chunk.bAborted)
+		{
+			OutDetection.Contacts.Reset();
+			OutDetection.LiftOffs.Reset();
+			OutDetection.TurningPoints.Reset();
+			OutDetection.bAborted = true;
+			return;
+		}
+		OutDetection.Contacts.Append(Chunk.Contacts);
+		OutDetection.LiftOffs.Append(Chunk.LiftOffs);
+		OutDetection.TurningPoints.Append(Chunk.TurningPoints);
+	}
+
+	OutDetection.Contacts.Sort();
+	OutDetection.LiftOffs.Sort();
+}
+
+void FTurningContactDetector::DetectRange(const FFootTrajectory& Trajectory, int32 Foot, const FContactDetectorSettings& Settings, int32 Begin, int32 End, FContactDetection& OutDetection)
+{
+	const int32 NumFrame = Trajectory.GetNumFrames() - 1;
+	const float * Z = Trajectory.GetAxis(Foot, 2);
+
+	// 转折点只在本块内使用，从当前工作线程的临时内存栈分配，返回时整体释放
+	FMemMark Mark(FMemStack::Get());
+	TArray<int32, TMemStackAllocator<>> TurningPoints;
+	// 转折点的亚帧偏移，落地时间沿用这一偏移
+	TArray<float, TMemStackAllocator<>> TurningOffsets;
+
+	// 遍历每一帧的位置数据，找到方向转折点
+	for (int32 i = Begin; i < End; i++)
+	{
+		if (((i - Begin) & 63) == 0 && Settings.IsOverBudget())
+		{
+			OutDetection.bAborted = true;
+			return;
+		}
+
+		const int32 l = (i == 0) ? NumFrame - 1 : i - 1;
+		const int32 n = (i == NumFrame - 1) ? 0 : i + 1;
+
+		const FVector Last = Trajectory.GetLocation(Foot, l);
+		const FVector Cur = Trajectory.GetLocation(Foot, i);
+		const FVector Next = Trajectory.GetLocation(Foot, n);
+
+		// 亚帧偏移只在找到转折点时计算
+		auto GetOffset = [&]()
+		{
+			return Settings.bSubFrameRefine ? FSubFrameRefiner::GetExtremumOffset(
+				GetMoveAxisValue(Last, Settings.Dir), GetMoveAxisValue(Cur, Settings.Dir), GetMoveAxisValue(Next, Settings.Dir)) : 0.f;
+		};
+
+		if (IsTurningPoint(Last, Cur, Next, Settings.Dir))
+		{
+			TurningPoints.Add(i);
+			TurningOffsets.Add(GetOffset());
+			OutDetection.TurningPoints.Add(Trajectory.GetTime(i));
+		}
+		else if (IsTurningPoint(Last, Cur, Next, Settings.Dir, true))
+		{
+			// 脚部向后移动到最远处，开始向前摆动的时刻作为离地时间
+			OutDetection.LiftOffs.Add(FSubFrameRefiner::GetTime(Trajectory, i, GetOffset()));
+		}
+	}
+
+	// 检查所有方向转折点的之后几帧，找到稳定低高度的点，搜索帧数有上限，不会超过一个循环
+	const int32 MaxSearch = FMath::Min(Settings.MaxSearchFrames, NumFrame);
+	for (int32 TurningIndex = 0; TurningIndex < TurningPoints.Num(); TurningIndex++)
+	{
+		int32 t = TurningPoints[TurningIndex];
+		int32 l = (t == 0) ? NumFrame - 1 : t - 1;
+		bool bFound = false;
+		for (int32 Step = 0; Step < MaxSearch; Step++)
+		{
+			const int32 n = (t == NumFrame - 1) ? 0 : t + 1;
+
+			// 脚部的下降幅度小于阈值（或者已为负数），进行标记
+			// 转折点本身即为稳定低点时，落地时间随转折点一起精化
+			if (Z[t] - Z[n] < Settings.TurningDescentThreshold)
+			{
+				float Offset = TurningOffsets[TurningIndex];
+				if (Step > 0 && Settings.bSubFrameRefine)
+				{
+					// 逐帧下降幅度在上一帧与当前帧之间穿过阈值的位置
+					const int32 nn = (n == NumFrame - 1) ? 0 : n + 1;
+					Offset = FSubFrameRefiner::GetCrossingOffset(Z[l] - Z[t], Z[t] - Z[n], Z[n] - Z[nn], Settings.TurningDescentThreshold);
+				}
+				OutDetection.Contacts.Add(FSubFrameRefiner::GetTime(Trajectory, n, Offset));
+				bFound = true;
+				break;
+			}
+			//否则先不进行标记，等待一个更稳定的低点
+			l = t;
+			t = n;
+		}
+
+		// 找不到稳定低点或超出时间预算，交由调用方使用后备检测器
+		if (!bFound || Settings.IsOverBudget())
+		{
+			OutDetection.bAborted = true;
+			return;
+		}
+	}
+}
+
+bool FTurningContactDetector::IsTurningPoint(FVector Last, FVector Cur, FVector Next, Direction Dir, bool bIsLiftOff)
+{
+	// 离地点为反方向的转折点，将位置取反后沿用相同的判断
+	if (bIsLiftOff)
+	{
+		Last = -Last;
+		Cur = -Cur;
+		Next = -Next;
+	}
+
+	if (Dir == Direction::l)
+	{
+		return Last.X < Cur.X && Cur.X > Next.X;
+	}
+	else if (Dir == Direction::r)
+	{
+		return Last.X > Cur.X && Cur.X < Next.X;
+	}
+
+	if (Dir == Direction::f || Dir == Direction::lf || Dir == Direction::rf)
+	{
+		return Last.Y < Cur.Y && Cur.Y > Next.Y;
+	}
+	else
+	{
+		return Last.Y > Cur.Y && Cur.Y < Next.Y;
+	}
+}
+
+void FHeightContactDetector::Detect(const FFootTrajectory& Trajectory, int32 Foot, const FContactDetectorSettings& Settings, FContactDetection& OutDetection) const
+{
+	OutDetection.Contacts.Reset();
+	OutDetection.LiftOffs.Reset();
+
+	const int32 NumFrames = Trajectory.GetNumFrames();
+	if (NumFrames < 2)
+	{
+		return;
+	}
+
+	// 第一次遍历，找到最低点
+	const float * Z = Trajectory.GetAxis(Foot, 2);
+	float MinHeight = Z[0];
+	for (int32 i = 1; i < NumFrames; i++)
+	{
+		MinHeight = FMath::Min(MinHeight, Z[i]);
+	}
+	const float Threshold = MinHeight + Settings.HeightTolerance;
+
+	// 如果动画的结束帧处在threshold以下，找到这一触地区间的开始点的前一帧，避免触地区间被循环点切开
+	int32 StartCount = 0;
+	if (Z[NumFrames - 1] < Threshold)
+	{
+		StartCount = NumFrames - 1;
+		while (StartCount > 0 && Z[StartCount] < Threshold)
+		{
+			StartCount--;
+		}
+	}
+
+	// 高度穿过阈值的亚帧时间
+	auto GetCrossingTime = [&](int32 Index)
+	{
+		if (!Settings.bSubFrameRefine)
+		{
+			return Trajectory.GetTime(Index);
+		}
+		const int32 Prev = Index == 0 ? NumFrames - 1 : Index - 1;
+		const int32 Next = Index == NumFrames - 1 ? 0 : Index + 1;
+		return FSubFrameRefiner::GetTime(Trajectory, Index, FSubFrameRefiner::GetCrossingOffset(Z[Prev], Z[Index], Z[Next], Threshold));
+	};
+
+	// 第二次遍历，计算触地过程中的总位移，并结合动画方向判断该触地区间是否有效
+	float CumulativeDist = 0;
+	bool bInContact = false;
+	int32 Contact = 0;
+	for (int32 i = 0; i <= NumFrames; i++)
+	{
+		const int32 Index = (i + StartCount) % NumFrames;
+		const int32 LastIndex = Index == 0 ? NumFrames - 1 : Index - 1;
+		const bool bBelow = i < NumFrames && Z[Index] < Threshold;
+
+		// 触地中，计算累积位移
+		if (bBelow)
+		{
+			if (!bInContact)
+			{
+				Contact = Index;
+				bInContact = true;
+			}
+			CumulativeDist += GetMoveAxisValue(Trajectory.GetLocation(Foot, Index), Settings.Dir) - GetMoveAxisValue(Trajectory.GetLocation(Foot, LastIndex), Settings.Dir);
+		}
+		// 当区间结束时，判断累计位移是否与动画移动方向吻合
+		else if (bInContact)
+		{
+			if (IsCumulativeDistanceValid(CumulativeDist, Settings.Dir))
+			{
+				OutDetection.Contacts.Add(GetCrossingTime(Contact));
+				OutDetection.LiftOffs.Add(GetCrossingTime(Index));
+			}
+			CumulativeDist = 0;
+			bInContact = false;
+		}
+	}
+
+	OutDetection.Contacts.Sort();
+	OutDetection.LiftOffs.Sort();
+}
+
+bool FHeightContactDetector::IsCumulativeDistanceValid(float Distance, Direction Dir)
+{
+	// 积累位移需要与移动方向相反
+	if (Dir == Direction::f || Dir == Direction::rf || Dir == Direction::lf)
+	{
+		return Distance < 0;
+	}
+	else if (Dir == Direction::b || Dir == Direction::rb || Dir == Direction::lb)
+	{
+		return Distance > 0;
+	}
+	else if (Dir == Direction::r)
+	{
+		return Distance > 0;
+	}
+	else
+	{
+		return Distance < 0;
+	}
+}
+
+void FVelocityContactDetector::Detect(const FFootTrajectory& Trajectory, int32 Foot, const FContactDetectorSettings& Settings, FContactDetection& OutDetection) const
+{
+	OutDetection.Contacts.Reset();
+	OutDetection.LiftOffs.Reset();
+
+	// 循环动画的最后一帧与第一帧相同，不参与检测
+	const int32 NumFrame = Trajectory.GetNumFrames() - 1;
+	if (NumFrame < 3)
+	{
+		return;
+	}
+
+	const float * X = Trajectory.GetAxis(Foot, 0);
+	const float * Y = Trajectory.GetAxis(Foot, 1);
+	const float * Z = Trajectory.GetAxis(Foot, 2);
+
+	// 高度范围，以及最低点与最高点所在的帧
+	int32 MinFrame = 0, MaxFrame = 0;
+	for (int32 i = 1; i < NumFrame; i++)
+	{
+		MinFrame = Z[i] < Z[MinFrame] ? i : MinFrame;
+		MaxFrame = Z[i] > Z[MaxFrame] ? i : MaxFrame;
+	}
+	const float MinHeight = Z[MinFrame];
+	const float Range = FMath::Max(Z[MaxFrame] - MinHeight, KINDA_SMALL_NUMBER);
+	const float PlantHeight = MinHeight + Range * Settings.PlantHeightRatio;
+	const float ReleaseHeight = MinHeight + Range * Settings.ReleaseHeightRatio;
+
+	// 循环的中心差分速度
+	const float InvDoubleDeltaTime = 0.5f / FMath::Max(Trajectory.GetTime(1) - Trajectory.GetTime(0), KINDA_SMALL_NUMBER);
+	auto GetVelocity = [&](int32 i)
+	{
+		const int32 l = (i == 0) ? NumFrame - 1 : i - 1;
+		const int32 n = (i == NumFrame - 1) ? 0 : i + 1;
+		return FVector(X[n] - X[l], Y[n] - Y[l], Z[n] - Z[l]) * InvDoubleDeltaTime;
+	};
+	const FVector StanceVelocity = GetVelocity(MinFrame);
+	auto GetDeviation = [&](int32 i)
+	{
+		return (GetVelocity(i) - StanceVelocity).Size();
+	};
+
+	// 事件帧的亚帧时间：对触发状态切换的那个条件（高度或速度）做穿越精化
+	auto GetEventTime = [&](int32 i, float HeightThreshold, float SpeedThreshold, bool bHeightTriggered)
+	{
+		if (!Settings.bSubFrameRefine)
+		{
+			return Trajectory.GetTime(i);
+		}
+		const int32 l = (i == 0) ? NumFrame - 1 : i - 1;
+		const int32 n = (i == NumFrame - 1) ? 0 : i + 1;
+		const float Offset = bHeightTriggered
+			? FSubFrameRefiner::GetCrossingOffset(Z[l], Z[i], Z[n], HeightThreshold)
+			: FSubFrameRefiner::GetCrossingOffset(GetDeviation(l), GetDeviation(i), GetDeviation(n), SpeedThreshold);
+		return FSubFrameRefiner::GetTime(Trajectory, i, Offset);
+	};
+
+	// 从最高点开始遍历一个完整循环，最后多走一帧以关闭末尾的站立区间
+	bool bPlanted = false;
+	for (int32 Step = 1; Step <= NumFrame; Step++)
+	{
+		const int32 i = (MaxFrame + Step) % NumFrame;
+		const float Deviation = GetDeviation(i);
+
+		if (!bPlanted && Deviation < Settings.PlantSpeedThreshold && Z[i] < PlantHeight)
+		{
+			// 上一帧已经足够低时，是速度条件最后满足
+			const int32 l = (i == 0) ? NumFrame - 1 : i - 1;
+			bPlanted = true;
+			OutDetection.Contacts.Add(GetEventTime(i, PlantHeight, Settings.PlantSpeedThreshold, Z[l] >= PlantHeight));
+		}
+		else if (bPlanted && (Deviation > Settings.ReleaseSpeedThreshold || Z[i] > ReleaseHeight))
+		{
+			bPlanted = false;
+			OutDetection.LiftOffs.Add(GetEventTime(i, ReleaseHeight, Settings.ReleaseSpeedThreshold, Z[i] > ReleaseHeight));
+		}
+	}
+
+	OutDetection.Contacts.Sort();
+	OutDetection.LiftOffs.Sort();
+}
+
+void FCrossingContactDetector::Detect(const FFootTrajectory& Trajectory, int32 Foot, const FContactDetectorSettings& Settings, FContactDetection& OutDetection) const
+{
+	OutDetection.Contacts.Reset();
+	OutDetection.LiftOffs.Reset();
+
+	const int32 NumFrames = Trajectory.GetNumFrames();
+	if (NumFrames < 2)
+	{
+		return;
+	}
+
+	FVector Last = Trajectory.GetLocation(Foot, NumFrames - 1);
+	for (int32 i = 0; i < NumFrames; i++)
+	{
+		const FVector Cur = Trajectory.GetLocation(Foot, i);
+		if (IsCrossingPoint(Cur, Last, Settings.Dir))
+		{
+			float Offset = 0.f;
+			if (Settings.bSubFrameRefine)
+			{
+				// 移动方向上的坐标穿过0（根骨骼）的位置
+				const FVector Next = Trajectory.GetLocation(Foot, i == NumFrames - 1 ? 0 : i + 1);
+				Offset = FSubFrameRefiner::GetCrossingOffset(GetMoveAxisValue(Last, Settings.Dir), GetMoveAxisValue(Cur, Settings.Dir), GetMoveAxisValue(Next, Settings.Dir), 0.f);
+			}
+			OutDetection.Contacts.Add(FSubFrameRefiner::GetTime(Trajectory, i, Offset));
+		}
+		Last = Cur;
+	}
+}
+
+bool FCrossingContactDetector::IsCrossingPoint(const FVector& Cur, const FVector& Last, Direction Dir)
+{
+	// 根据方向判断当前帧是否为脚部骨骼越过根骨骼的时刻
+	if (Dir == Direction::f || Dir == Direction::rf || Dir == Direction::lf)
+	{
+		return Cur.Y > 0 && Last.Y < 0;
+	}
+	else if (Dir == Direction::b || Dir == Direction::rb || Dir == Direction::lb)
+	{
+		return Cur.Y < 0 && Last.Y > 0;
+	}
+	else if (Dir == Direction::r)
+	{
+		return Cur.X < 0 && Last.X > 0;
+	}
+	else
+	{
+		return Cur.X > 0 && Last.X < 0;
+	}
+}
@@ -0,0 +1,502 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "AnimCurveToolCurveBaker.h"
+
+#include "AnimCurveTool.h"
+#include "AnimCurveToolScheduler.h"
+#include "Async/ParallelFor.h"
+#include "Engine/CurveTable.h"
+#include "Animation/Skeleton.h"
+#include "Math/VectorRegister.h"
+
+FName FCurveBakeRequest::GetCurveName() const
+{
+	static const TCHAR* AxisNames[3] = { TEXT("X"), TEXT("Y"), TEXT("Z") };
+	return FName(*FString::Printf(TEXT("%s_%s%s"), *BoneName.ToString(), *GetChannelName(Channel), AxisNames[FMath::Clamp(Axis, 0, 2)]));
+}
+
+FString FCurveBakeRequest::GetChannelName(ECurveBakeChannel Channel)
+{
+	switch (Channel)
+	{
+	case ECurveBakeChannel::Translation: return FString("Translation");
+	case ECurveBakeChannel::Rotation: return FString("Rotation");
+	default: return FString("Scale");
+	}
+}
+
+bool FBoneChainSampler::Initialize(UAnimSequence* InAnimSequence, const FCurveBakeSettings& InSettings, FCurveBakeResult& OutResult)
+{
+	AnimSequence = InAnimSequence;
+	Settings = &InSettings;
+	Result = &OutResult;
+	RefSkeleton = &AnimSequence->GetSkeleton()->GetReferenceSkeleton();
+
+	OutResult.AnimSequence = AnimSequence;
+	OutResult.bIsValid = false;
+	OutResult.CurveNames.Reset();
+
+	const TArray<FTrackToSkeletonMap> & TrackMap = AnimSequence->GetRawTrackToSkeletonMapTable();
+
+	// 收集需要采样的骨骼，根骨骼空间下还需要其到根的所有祖先
+	BoneIndices.Reset();
+	ValidRequests.Reset();
+	for (const FCurveBakeRequest & Request : Settings->Requests)
+	{
+		int32 BoneIndex = RefSkeleton->FindBoneIndex(Request.BoneName);
+		if (BoneIndex == INDEX_NONE)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Bone %s not found in animation %s"), *Request.BoneName.ToString(), *AnimSequence->GetName());
+			continue;
+		}
+		ValidRequests.Add(&Request);
+
+		while (BoneIndex != INDEX_NONE)
+		{
+			BoneIndices.AddUnique(BoneIndex);
+			BoneIndex = Settings->bRootRelative ? RefSkeleton->GetParentIndex(BoneIndex) : INDEX_NONE;
+		}
+	}
+
+	if (ValidRequests.Num() == 0)
+	{
+		return false;
+	}
+
+	// 骨骼索引中父骨骼总在子骨骼之前，排序后可以按顺序逐级组合变换
+	BoneIndices.Sort();
+	const int32 NumBones = BoneIndices.Num();
+	ParentSlots.SetNum(NumBones);
+	TrackIndices.SetNum(NumBones);
+	for (int32 Slot = 0; Slot < NumBones; Slot++)
+	{
+		const int32 ParentIndex = RefSkeleton->GetParentIndex(BoneIndices[Slot]);
+		ParentSlots[Slot] = Settings->bRootRelative ? BoneIndices.IndexOfByKey(ParentIndex) : INDEX_NONE;
+		TrackIndices[Slot] = FAnimCurveToolModule::GetAnimTrackIndexForSkeletonBone(BoneIndices[Slot], TrackMap);
+	}
+
+	CurveSlots.Reset();
+	for (const FCurveBakeRequest * Request : ValidRequests)
+	{
+		CurveSlots.Add(BoneIndices.IndexOfByKey(RefSkeleton->FindBoneIndex(Request->BoneName)));
+		OutResult.CurveNames.Add(Request->GetCurveName());
+	}
+
+	const int32 NumFrames = AnimSequence->GetNumberOfFrames();
+	OutResult.NumFrames = NumFrames;
+	OutResult.Times.SetNumUninitialized(NumFrames);
+	OutResult.Values.SetNumUninitialized(NumFrames * ValidRequests.Num());
+	for (int32 Frame = 0; Frame < NumFrames; Frame++)
+	{
+		OutResult.Times[Frame] = AnimSequence->GetTimeAtFrame(Frame);
+	}
+
+	Transforms.SetNum(NumBones);
+
+	bPositionsOnly = Settings->bRootRelative;
+	for (const FCurveBakeRequest * Request : ValidRequests)
+	{
+		bPositionsOnly &= Request->Channel == ECurveBakeChannel::Translation;
+	}
+	SlotPositionsOnly.Init(true, NumBones);
+	for (int32 Slot = 0; Slot < NumBones; Slot++)
+	{
+		if (ParentSlots[Slot] != INDEX_NONE)
+		{
+			SlotPositionsOnly[ParentSlots[Slot]] = false;
+		}
+	}
+	Lanes.SetNumZeroed(NumBones * NumComponents * NumLanes);
+
+	OutResult.bIsValid = true;
+	return true;
+}
+
+FTransform FBoneChainSampler::GetLocalTransform(int32 Slot, float Time) const
+{
+	FTransform BoneTransform;
+	if (TrackIndices[Slot] != INDEX_NONE)
+	{
+		AnimSequence->GetBoneTransform(BoneTransform, TrackIndices[Slot], Time, false);
+	}
+	else
+	{
+		// 没有动画轨道的骨骼使用参考姿势
+		BoneTransform = RefSkeleton->GetRefBonePose()[BoneIndices[Slot]];
+	}
+
+	if (Settings->bRootRelative && BoneIndices[Slot] == 0)
+	{
+		BoneTransform.SetLocation(FVector(0, 0, 0));
+	}
+	return BoneTransform;
+}
+
+void FBoneChainSampler::SampleFrame(int32 Frame)
+{
+	const float Time = Result->Times[Frame];
+	const int32 NumFrames = Result->NumFrames;
+
+	for (int32 Slot = 0; Slot < BoneIndices.Num(); Slot++)
+	{
+		const FTransform BoneTransform = GetLocalTransform(Slot, Time);
+		if (Settings->bRootRelative && ParentSlots[Slot] != INDEX_NONE)
+		{
+			Transforms[Slot] = BoneTransform * Transforms[ParentSlots[Slot]];
+		}
+		else
+		{
+			Transforms[Slot] = BoneTransform;
+		}
+	}
+
+	for (int32 Curve = 0; Curve < ValidRequests.Num(); Curve++)
+	{
+		const FCurveBakeRequest & Request = *ValidRequests[Curve];
+		const FTransform & Transform = Transforms[CurveSlots[Curve]];
+		float Value;
+		switch (Request.Channel)
+		{
+		case ECurveBakeChannel::Translation:
+			Value = Transform.GetLocation()[Request.Axis] * Settings->TranslationScale;
+			break;
+		case ECurveBakeChannel::Rotation:
+			Value = Transform.GetRotation().Euler()[Request.Axis] * Settings->RotationScale;
+			break;
+		default:
+			Value = Transform.GetScale3D()[Request.Axis];
+			break;
+		}
+		Result->Values[Curve * NumFrames + Frame] = Value;
+	}
+}
+
+void FBoneChainSampler::SampleFrames(int32 Begin, int32 End)
+{
+	if (!bPositionsOnly)
+	{
+		for (int32 Frame = Begin; Frame < End; Frame++)
+		{
+			SampleFrame(Frame);
+		}
+		return;
+	}
+
+	const int32 NumFrames = Result->NumFrames;
+	const int32 NumBones = BoneIndices.Num();
+	for (int32 Frame = Begin; Frame < End; Frame += NumLanes)
+	{
+		const int32 NumValid = FMath::Min(NumLanes, End - Frame);
+
+		// 局部变换写入SoA缓冲，不足4帧时重复最后一帧
+		for (int32 Lane = 0; Lane < NumLanes; Lane++)
+		{
+			const float Time = Result->Times[Frame + FMath::Min(Lane, NumValid - 1)];
+			for (int32 Slot = 0; Slot < NumBones; Slot++)
+			{
+				const FTransform BoneTransform = GetLocalTransform(Slot, Time);
+				const FQuat Rotation = BoneTransform.GetRotation();
+				const FVector Translation = BoneTransform.GetTranslation();
+				const FVector Scale = BoneTransform.GetScale3D();
+				float * Bone = Lanes.GetData() + Slot * NumComponents * NumLanes + Lane;
+				Bone[0 * NumLanes] = Rotation.X;
+				Bone[1 * NumLanes] = Rotation.Y;
+				Bone[2 * NumLanes] = Rotation.Z;
+				Bone[3 * NumLanes] = Rotation.W;
+				Bone[4 * NumLanes] = Translation.X;
+				Bone[5 * NumLanes] = Translation.Y;
+				Bone[6 * NumLanes] = Translation.Z;
+				Bone[7 * NumLanes] = Scale.X;
+				Bone[8 * NumLanes] = Scale.Y;
+				Bone[9 * NumLanes] = Scale.Z;
+			}
+		}
+
+		ComposeChainLanes(Lanes.GetData(), ParentSlots.GetData(), SlotPositionsOnly.GetData(), NumBones);
+
+		// 只写出有效的帧
+		for (int32 Curve = 0; Curve < ValidRequests.Num(); Curve++)
+		{
+			const float * Position = Lanes.GetData() + (CurveSlots[Curve] * NumComponents + 4 + ValidRequests[Curve]->Axis) * NumLanes;
+			float * Out = Result->Values.GetData() + Curve * NumFrames + Frame;
+			for (int32 Lane = 0; Lane < NumValid; Lane++)
+			{
+				Out[Lane] = Position[Lane] * Settings->TranslationScale;
+			}
+		}
+	}
+}
+
+void FBoneChainSampler::ComposeChainLanes(float* Lanes, const int32* ParentSlots, const bool* PositionsOnly, int32 NumBones)
+{
+	const VectorRegister Two = VectorSetFloat1(2.f);
+
+	// 父骨骼已经组合为链根空间，子骨骼 = 局部 * 父骨骼：
+	// 旋转 Qp * Ql，位移 Qp.Rotate(Sp * Tl) + Tp，缩放 Sp * Sl
+	for (int32 Slot = 0; Slot < NumBones; Slot++)
+	{
+		if (ParentSlots[Slot] == INDEX_NONE)
+		{
+			continue;
+		}
+		const float * P = Lanes + ParentSlots[Slot] * NumComponents * NumLanes;
+		float * L = Lanes + Slot * NumComponents * NumLanes;
+
+		const VectorRegister Px = VectorLoad(P + 0 * NumLanes);
+		const VectorRegister Py = VectorLoad(P + 1 * NumLanes);
+		const VectorRegister Pz = VectorLoad(P + 2 * NumLanes);
+		const VectorRegister Pw = VectorLoad(P + 3 * NumLanes);
+		const VectorRegister Psx = VectorLoad(P + 7 * NumLanes);
+		const VectorRegister Psy = VectorLoad(P + 8 * NumLanes);
+		const VectorRegister Psz = VectorLoad(P + 9 * NumLanes);
+
+		// 位移：先缩放，再用 v' = v + w*t + q×t（t = 2*q×v）旋转
+		const VectorRegister Vx = VectorMultiply(Psx, VectorLoad(L + 4 * NumLanes));
+		const VectorRegister Vy = VectorMultiply(Psy, VectorLoad(L + 5 * NumLanes));
+		const VectorRegister Vz = VectorMultiply(Psz, VectorLoad(L + 6 * NumLanes));
+		const VectorRegister Tx = VectorMultiply(Two, VectorSubtract(VectorMultiply(Py, Vz), VectorMultiply(Pz, Vy)));
+		const VectorRegister Ty = VectorMultiply(Two, VectorSubtract(VectorMultiply(Pz, Vx), VectorMultiply(Px, Vz)));
+		const VectorRegister Tz = VectorMultiply(Two, VectorSubtract(VectorMultiply(Px, Vy), VectorMultiply(Py, Vx)));
+		const VectorRegister Rx = VectorAdd(VectorMultiplyAdd(Pw, Tx, Vx), VectorSubtract(VectorMultiply(Py, Tz), VectorMultiply(Pz, Ty)));
+		const VectorRegister Ry = VectorAdd(VectorMultiplyAdd(Pw, Ty, Vy), VectorSubtract(VectorMultiply(Pz, Tx), VectorMultiply(Px, Tz)));
+		const VectorRegister Rz = VectorAdd(VectorMultiplyAdd(Pw, Tz, Vz), VectorSubtract(VectorMultiply(Px, Ty), VectorMultiply(Py, Tx)));
+		VectorStore(VectorAdd(Rx, VectorLoad(P + 4 * NumLanes)), L + 4 * NumLanes);
+		VectorStore(VectorAdd(Ry, VectorLoad(P + 5 * NumLanes)), L + 5 * NumLanes);
+		VectorStore(VectorAdd(Rz, VectorLoad(P + 6 * NumLanes)), L + 6 * NumLanes);
+
+		// 末端骨骼的旋转与缩放不会再被使用
+		if (PositionsOnly[Slot])
+		{
+			continue;
+		}
+
+		const VectorRegister Lx = VectorLoad(L + 0 * NumLanes);
+		const VectorRegister Ly = VectorLoad(L + 1 * NumLanes);
+		const VectorRegister Lz = VectorLoad(L + 2 * NumLanes);
+		const VectorRegister Lw = VectorLoad(L + 3 * NumLanes);
+		const VectorRegister Qx = VectorSubtract(VectorMultiplyAdd(Pw, Lx, VectorMultiplyAdd(Px, Lw, VectorMultiply(Py, Lz))), VectorMultiply(Pz, Ly));
+		const VectorRegister Qy = VectorSubtract(VectorMultiplyAdd(Pw, Ly, VectorMultiplyAdd(Py, Lw, VectorMultiply(Pz, Lx))), VectorMultiply(Px, Lz));
+		const VectorRegister Qz = VectorSubtract(VectorMultiplyAdd(Pw, Lz, VectorMultiplyAdd(Pz, Lw, VectorMultiply(Px, Ly))), VectorMultiply(Py, Lx));
+		const VectorRegister Qw = VectorSubtract(VectorMultiply(Pw, Lw), VectorMultiplyAdd(Px, Lx, VectorMultiplyAdd(Py, Ly, VectorMultiply(Pz, Lz))));
+		VectorStore(Qx, L + 0 * NumLanes);
+		VectorStore(Qy, L + 1 * NumLanes);
+		VectorStore(Qz, L + 2 * NumLanes);
+		VectorStore(Qw, L + 3 * NumLanes);
+		VectorStore(VectorMultiply(Psx, VectorLoad(L + 7 * NumLanes)), L + 7 * NumLanes);
+		VectorStore(VectorMultiply(Psy, VectorLoad(L + 8 * NumLanes)), L + 8 * NumLanes);
+		VectorStore(VectorMultiply(Psz, VectorLoad(L + 9 * NumLanes)), L + 9 * NumLanes);
+	}
+}
+
+bool FCurveBaker::SampleSequence(UAnimSequence* AnimSequence, const FCurveBakeSettings& Settings, FCurveBakeResult& OutResult)
+{
+	FBoneChainSampler Sampler;
+	if (!Sampler.Initialize(AnimSequence, Settings, OutResult))
+	{
+		return false;
+	}
+
+	// 每帧的结果互不依赖，各块只写入自己的帧，骨骼变换的临时缓冲随采样器复制
+	const int32 NumFrames = OutResult.NumFrames;
+	const int32 ChunkFrames = Settings.ChunkFrames > 0 ? Settings.ChunkFrames : NumFrames;
+	const int32 NumChunks = FMath::DivideAndRoundUp(NumFrames, FMath::Max(1, ChunkFrames));
+	ParallelFor(NumChunks, [&](int32 Chunk)
+	{
+		FBoneChainSampler ChunkSampler = Sampler;
+		ChunkSampler.SampleFrames(Chunk * ChunkFrames, FMath::Min(NumFrames, (Chunk + 1) * ChunkFrames));
+	}, NumChunks <= 1);
+	return true;
+}
+
+void FCurveBaker::SampleSequences(const TArray<UAnimSequence*>& AnimSequences, const FCurveBakeSettings& Settings, TArray<FCurveBakeResult>& OutResults)
+{
+	OutResults.Reset();
+	OutResults.SetNum(AnimSequences.Num());
+
+	// 先为每个动画准备采样器并分配结果，开销为帧数乘以需要组合的骨骼数量
+	TArray<FBoneChainSampler> Samplers;
+	Samplers.SetNum(AnimSequences.Num());
+	TArray<int64> Costs;
+	TArray<int32> NumFrames;
+	for (int32 Index = 0; Index < AnimSequences.Num(); Index++)
+	{
+		const bool bValid = Samplers[Index].Initialize(AnimSequences[Index], Settings, OutResults[Index]);
+		NumFrames.Add(bValid ? OutResults[Index].NumFrames : 0);
+		Costs.Add(int64(NumFrames.Last()) * Samplers[Index].GetNumBones());
+	}
+
+	TArray<FBatchJob> Jobs;
+	FBatchScheduler::MakeJobs(Costs, NumFrames, true, Jobs);
+	FBatchScheduler::Run(Jobs, [&](const FBatchJob& Job)
+	{
+		FBoneChainSampler JobSampler = Samplers[Job.Item];
+		JobSampler.SampleFrames(Job.FrameBegin, Job.FrameEnd);
+	});
+}
+
+void FCurveBaker::MakeCurveKeys(const float* Times, const float* Values, int32 NumSamples, float Tolerance, TArray<FRichCurveKey>& OutKeys)
+{
+	auto AddKey = [&OutKeys](float Time, float Value)
+	{
+		FRichCurveKey & Key = OutKeys.Emplace_GetRef(Time, Value);
+		Key.InterpMode = RCIM_Linear;
+	};
+
+	OutKeys.Reset();
+	if (Tolerance <= 0.f || NumSamples <= 2)
+	{
+		OutKeys.Reserve(NumSamples);
+		for (int32 i = 0; i < NumSamples; i++)
+		{
+			AddKey(Times[i], Values[i]);
+		}
+		return;
+	}
+
+	float AnchorTime = Times[0];
+	float AnchorValue = Values[0];
+	AddKey(AnchorTime, AnchorValue);
+
+	// 从锚点出发，能让之前所有采样误差都在Tolerance之内的斜率区间
+	float SlopeLow = -MAX_flt;
+	float SlopeHigh = MAX_flt;
+	for (int32 i = 1; i < NumSamples; i++)
+	{
+		const float DeltaTime = Times[i] - AnchorTime;
+		if (DeltaTime <= KINDA_SMALL_NUMBER)
+		{
+			continue;
+		}
+
+		const float Low = FMath::Max(SlopeLow, (Values[i] - Tolerance - AnchorValue) / DeltaTime);
+		const float High = FMath::Min(SlopeHigh, (Values[i] + Tolerance - AnchorValue) / DeltaTime);
+		if (Low <= High)
+		{
+			SlopeLow = Low;
+			SlopeHigh = High;
+			continue;
+		}
+
+		// 当前采样无法被同一条直线覆盖，在上一个采样处结束线段
+		// 关键帧取区间中间的斜率，其值与上一个采样的误差同样在Tolerance之内，并作为下一段的锚点
+		AnchorValue += 0.5f * (SlopeLow + SlopeHigh) * (Times[i - 1] - AnchorTime);
+		AnchorTime = Times[i - 1];
+		AddKey(AnchorTime, AnchorValue);
+
+		const float NewDeltaTime = Times[i] - AnchorTime;
+		SlopeLow = (Values[i] - Tolerance - AnchorValue) / NewDeltaTime;
+		SlopeHigh = (Values[i] + Tolerance - AnchorValue) / NewDeltaTime;
+	}
+
+	const float LastTime = Times[NumSamples - 1];
+	if (LastTime > AnchorTime)
+	{
+		AddKey(LastTime, AnchorValue + 0.5f * (SlopeLow + SlopeHigh) * (LastTime - AnchorTime));
+	}
+}
+
+void FCurveBaker::MakeBakedCurves(const FCurveBakeResult& Result, float Tolerance, TArray<FBakedCurve>& OutCurves)
+{
+	OutCurves.Reset(Result.CurveNames.Num());
+	for (int32 Curve = 0; Curve < Result.CurveNames.Num(); Curve++)
+	{
+		FBakedCurve & Baked = OutCurves.AddDefaulted_GetRef();
+		Baked.Name = Result.CurveNames[Curve];
+		Baked.NumSamples = Result.NumFrames;
+		MakeCurveKeys(Result.Times.GetData(), Result.GetCurveValues(Curve), Result.NumFrames, Tolerance, Baked.Keys);
+	}
+}
+
+void FCurveBaker::LogCompression(const TArray<FBakedAnimCurves>& BakedAnims)
+{
+	int64 NumSamples = 0;
+	int64 NumKeys = 0;
+	for (const FBakedAnimCurves & Baked : BakedAnims)
+	{
+		for (const FBakedCurve & Curve : Baked.Curves)
+		{
+			NumSamples += Curve.NumSamples;
+			NumKeys += Curve.Keys.Num();
+		}
+	}
+
+	if (NumKeys > 0)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Curve key reduction: %lld samples -> %lld keys, compression ratio %.2f:1"),
+			NumSamples, NumKeys, (double)NumSamples / (double)NumKeys);
+	}
+}
+
+bool FCurveBaker::WriteAnimationCurves(UAnimSequence* AnimSequence, const TArray<FBakedCurve>& Curves)
+{
+	USkeleton * Skeleton = AnimSequence ? AnimSequence->GetSkeleton() : nullptr;
+	if (Skeleton == nullptr || Curves.Num() == 0)
+	{
+		return false;
+	}
+
+	AnimSequence->Modify();
+	for (const FBakedCurve & Baked : Curves)
+	{
+		// 曲线名需要先注册到骨骼的曲线映射中
+		FSmartName SmartName;
+		Skeleton->AddSmartNameAndModify(USkeleton::AnimCurveMappingName, Baked.Name, SmartName);
+
+		FFloatCurve * Curve = static_cast<FFloatCurve*>(AnimSequence->RawCurveData.GetCurveData(SmartName.UID, ERawCurveTrackTypes::RCT_Float));
+		if (Curve == nullptr)
+		{
+			AnimSequence->RawCurveData.AddCurveData(SmartName);
+			Curve = static_cast<FFloatCurve*>(AnimSequence->RawCurveData.GetCurveData(SmartName.UID, ERawCurveTrackTypes::RCT_Float));
+		}
+
+		if (Curve)
+		{
+			Curve->FloatCurve.SetKeys(Baked.Keys);
+		}
+	}
+
+	// 所有曲线写完后统一刷新
+	AnimSequence->MarkRawDataAsModified();
+	AnimSequence->PostEditChange();
+	AnimSequence->MarkPackageDirty();
+	return true;
+}
+
+UPackage* FCurveBaker::WriteCurveTableAsset(UAnimSequence* AnimSequence, const TArray<FBakedCurve>& Curves, const FString& SavePath)
+{
+	if (AnimSequence == nullptr || Curves.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	// 每个动画的所有曲线保存在同一个曲线表中，而不是每条曲线一个资源
+	const FString AssetName = AnimSequence->GetName() + "_Curves";
+	const FString PackageName = SavePath / AssetName;
+	UPackage * Package = CreatePackage(*PackageName);
+	Package->FullyLoad();
+
+	UCurveTable * CurveTable = FindObject<UCurveTable>(Package, *AssetName);
+	const bool bCreated = CurveTable == nullptr;
+	if (bCreated)
+	{
+		CurveTable = NewObject<UCurveTable>(Package, *AssetName, RF_Public | RF_Standalone | RF_Transactional);
+	}
+	CurveTable->Modify();
+
+	for (const FBakedCurve & Baked : Curves)
+	{
+		FRichCurve * Curve = CurveTable->FindRichCurve(Baked.Name, FString(), false);
+		if (Curve == nullptr)
+		{
+			Curve = &CurveTable->AddRichCurve(Baked.Name);
+		}
+		Curve->SetKeys(Baked.Keys);
+	}
+
+	if (bCreated)
+	{
+		FAssetRegistryModule::AssetCreated(CurveTable);
+	}
+	Package->MarkPackageDirty();
+	return Package;
+}
@@ -0,0 +1,148 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "AnimCurveToolDistanceCurve.h"
+
+#include "AnimCurveTool.h"
+#include "AnimCurveToolCurveBaker.h"
+
+const FName FDistanceCurveBaker::DistanceCurveName("Distance");
+
+bool FDistanceCurveBaker::MakeDistanceCurve(UAnimSequence* AnimSequence, float StopSpeedRatio, FCurveBakeResult& OutResult, EDistanceClipType& OutClipType)
+{
+	OutResult.AnimSequence = AnimSequence;
+	OutResult.bIsValid = false;
+	OutResult.CurveNames.Reset();
+	OutClipType = EDistanceClipType::Cycle;
+
+	const int32 NumFrames = AnimSequence->GetNumberOfFrames();
+	const int32 RootTrack = FAnimCurveToolModule::GetAnimTrackIndexForSkeletonBone(0, AnimSequence->GetRawTrackToSkeletonMapTable());
+	if (RootTrack == INDEX_NONE || NumFrames < 2)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Animation %s has no root motion. Skipping."), *AnimSequence->GetName());
+		return false;
+	}
+
+	// 一次遍历根骨骼轨道，累积水平面上的位移长度
+	TArray<FVector2D> Positions;
+	TArray<float> Distances;
+	Positions.SetNumUninitialized(NumFrames);
+	Distances.SetNumUninitialized(NumFrames);
+	OutResult.Times.SetNumUninitialized(NumFrames);
+
+	float Distance = 0.f;
+	for (int32 Frame = 0; Frame < NumFrames; Frame++)
+	{
+		const float Time = AnimSequence->GetTimeAtFrame(Frame);
+		FTransform RootTransform;
+		AnimSequence->GetBoneTransform(RootTransform, RootTrack, Time, false);
+
+		Positions[Frame] = FVector2D(RootTransform.GetLocation());
+		if (Frame > 0)
+		{
+			Distance += FVector2D::Distance(Positions[Frame], Positions[Frame - 1]);
+		}
+		Distances[Frame] = Distance;
+		OutResult.Times[Frame] = Time;
+	}
+
+	if (Distance < KINDA_SMALL_NUMBER)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Animation %s has no root motion. Skipping."), *AnimSequence->GetName());
+		return false;
+	}
+
+	int32 PivotFrame = INDEX_NONE;
+	OutClipType = ClassifyClip(Distances, Positions, OutResult.Times, StopSpeedRatio, PivotFrame);
+
+	// 按动画类型决定零点：停步动画以最后一帧为零点，转身动画以转身帧为零点
+	float Origin = 0.f;
+	if (OutClipType == EDistanceClipType::Stop)
+	{
+		Origin = Distances[NumFrames - 1];
+	}
+	else if (OutClipType == EDistanceClipType::Pivot)
+	{
+		Origin = Distances[PivotFrame];
+	}
+
+	OutResult.NumFrames = NumFrames;
+	OutResult.CurveNames.Add(DistanceCurveName);
+	OutResult.Values.SetNumUninitialized(NumFrames);
+	for (int32 Frame = 0; Frame < NumFrames; Frame++)
+	{
+		OutResult.Values[Frame] = Distances[Frame] - Origin;
+	}
+
+	OutResult.bIsValid = true;
+	return true;
+}
+
+EDistanceClipType FDistanceCurveBaker::ClassifyClip(const TArray<float>& Distances, const TArray<FVector2D>& Positions, const TArray<float>& Times, float StopSpeedRatio, int32& OutPivotFrame)
+{
+	const int32 NumFrames = Distances.Num();
+	OutPivotFrame = INDEX_NONE;
+
+	TArray<float> Speeds;
+	Speeds.SetNumZeroed(NumFrames);
+	float MaxSpeed = 0.f;
+	for (int32 Frame = 1; Frame < NumFrames; Frame++)
+	{
+		const float DeltaTime = FMath::Max(Times[Frame] - Times[Frame - 1], KINDA_SMALL_NUMBER);
+		Speeds[Frame] = (Distances[Frame] - Distances[Frame - 1]) / DeltaTime;
+		MaxSpeed = FMath::Max(MaxSpeed, Speeds[Frame]);
+	}
+	Speeds[0] = Speeds[1];
+	const float StopSpeed = MaxSpeed * StopSpeedRatio;
+
+	// 首尾几帧的平均速度
+	const int32 EdgeFrames = FMath::Clamp(NumFrames / 10, 1, 3);
+	float StartSpeed = 0.f, EndSpeed = 0.f;
+	for (int32 i = 0; i < EdgeFrames; i++)
+	{
+		StartSpeed += Speeds[i] / EdgeFrames;
+		EndSpeed += Speeds[NumFrames - 1 - i] / EdgeFrames;
+	}
+
+	// 转身：动画中段有速度接近0的帧，且前后两段的移动方向相反
+	int32 MinFrame = INDEX_NONE;
+	float MinSpeed = MAX_flt;
+	for (int32 Frame = EdgeFrames; Frame < NumFrames - EdgeFrames; Frame++)
+	{
+		if (Speeds[Frame] < MinSpeed)
+		{
+			MinSpeed = Speeds[Frame];
+			MinFrame = Frame;
+		}
+	}
+	if (MinFrame != INDEX_NONE && MinSpeed <= StopSpeed)
+	{
+		const FVector2D Before = Positions[MinFrame] - Positions[0];
+		const FVector2D After = Positions[NumFrames - 1] - Positions[MinFrame];
+		if ((Before | After) < 0.f)
+		{
+			OutPivotFrame = MinFrame;
+			return EDistanceClipType::Pivot;
+		}
+	}
+
+	if (StartSpeed <= StopSpeed && EndSpeed > StopSpeed)
+	{
+		return EDistanceClipType::Start;
+	}
+	if (StartSpeed > StopSpeed && EndSpeed <= StopSpeed)
+	{
+		return EDistanceClipType::Stop;
+	}
+	return EDistanceClipType::Cycle;
+}
+
+FString FDistanceCurveBaker::GetClipTypeName(EDistanceClipType ClipType)
+{
+	switch (ClipType)
+	{
+	case EDistanceClipType::Start: return FString("Start");
+	case EDistanceClipType::Stop: return FString("Stop");
+	case EDistanceClipType::Pivot: return FString("Pivot");
+	default: return FString("Cycle");
+	}
+}
@@ -0,0 +1,529 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "AnimCurveToolGaitCache.h"
+
+#include "AnimCurveTool.h"
+#include "AnimCurveToolContactDetector.h"
+#include "AnimCurveToolTrajectoryCache.h"
+#include "Algo/BinarySearch.h"
+#include "Animation/AnimSequence.h"
+#include "Animation/Skeleton.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Hash/CityHash.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace GaitCache
+{
+	// 写入文件的一项，来自已有的缓存项或新的分析结果
+	struct FWriteItem
+	{
+		TArray<ANSICHAR> Path;
+		TArray<ANSICHAR> DetectorName;
+		uint64 PathHash = 0;
+		uint64 DataHash = 0;
+		uint64 IdentityHash = 0;
+		uint64 SettingsHash = 0;
+		int64 AnalysisTicks = 0;
+		float Tolerance = 0.f;
+		uint8 Dir = 0;
+		uint8 bIsValid = 0;
+		uint8 bUsedFallback = 0;
+		TArrayView<const float> Markers[4];
+		TArray<FGaitCacheInterval> Intervals;
+		uint32 TrajectoryNumFrames = 0;
+		uint32 TrajectoryNumCurves = 0;
+		// 与文件中的布局相同：最小值，步长，量化值，补齐到4字节
+		TArray<uint8> Trajectory;
+	};
+
+	static uint64 GetTrajectorySize(uint64 NumFrames, uint64 NumCurves)
+	{
+		return Align(NumCurves * 2 * sizeof(float) + NumCurves * NumFrames * sizeof(uint16), 4);
+	}
+
+	static void WriteTrajectory(const FQuantizedTrajectory& Trajectory, FWriteItem& OutItem)
+	{
+		const int32 NumCurves = Trajectory.CurveNames.Num();
+		OutItem.TrajectoryNumFrames = Trajectory.NumFrames;
+		OutItem.TrajectoryNumCurves = NumCurves;
+		OutItem.Trajectory.SetNumZeroed((int32)GetTrajectorySize(Trajectory.NumFrames, NumCurves));
+		uint8 * Out = OutItem.Trajectory.GetData();
+		FMemory::Memcpy(Out, Trajectory.Mins.GetData(), NumCurves * sizeof(float));
+		FMemory::Memcpy(Out + NumCurves * sizeof(float), Trajectory.Steps.GetData(), NumCurves * sizeof(float));
+		FMemory::Memcpy(Out + NumCurves * 2 * sizeof(float), Trajectory.Values.GetData(), Trajectory.Values.Num() * sizeof(uint16));
+	}
+
+	static void ToUTF8(const FString& String, TArray<ANSICHAR>& OutChars)
+	{
+		const FTCHARToUTF8 Converted(*String);
+		OutChars.Reset();
+		OutChars.Append(Converted.Get(), Converted.Length());
+	}
+}
+
+FString FGaitCacheEntryView::GetPath() const
+{
+	const FUTF8ToTCHAR Converted(PathChars, Entry->PathLength);
+	return FString(Converted.Length(), Converted.Get());
+}
+
+FName FGaitCacheEntryView::GetDetectorName() const
+{
+	const FUTF8ToTCHAR Converted(DetectorChars, Entry->DetectorLength);
+	return FName(Converted.Length(), Converted.Get());
+}
+
+FGaitCache::FGaitCache()
+{
+}
+
+FGaitCache::~FGaitCache()
+{
+	Close();
+}
+
+FString FGaitCache::GetDefaultFilename()
+{
+	return FPaths::ProjectSavedDir() / TEXT("AnimCurveTool") / TEXT("GaitCache.bin");
+}
+
+bool FGaitCache::Open(const FString& InFilename)
+{
+	Close();
+	Filename = InFilename;
+
+	int64 Size = 0;
+	MappedFile = FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Filename);
+	if (MappedFile != nullptr)
+	{
+		MappedRegion = MappedFile->MapRegion(0, MappedFile->GetFileSize());
+		if (MappedRegion != nullptr)
+		{
+			Data = MappedRegion->GetMappedPtr();
+			Size = MappedRegion->GetMappedSize();
+		}
+	}
+	else if (FFileHelper::LoadFileToArray(LoadedData, *Filename, FILEREAD_Silent))
+	{
+		// 不支持映射的平台一次读入
+		Data = LoadedData.GetData();
+		Size = LoadedData.Num();
+	}
+
+	// 只检查文件头与各段的范围，缓存项本身不做任何解析
+	const FGaitCacheHeader * FileHeader = reinterpret_cast<const FGaitCacheHeader*>(Data);
+	const bool bValid = Data != nullptr && Size >= (int64)sizeof(FGaitCacheHeader)
+		&& FileHeader->Magic == Magic && FileHeader->Version == Version && FileHeader->FileSize == (uint64)Size
+		&& FileHeader->IndexOffset + FileHeader->NumEntries * sizeof(FGaitCacheIndexEntry) <= FileHeader->StringOffset
+		&& FileHeader->StringOffset <= FileHeader->MarkerOffset && FileHeader->MarkerOffset <= FileHeader->IntervalOffset
+		&& FileHeader->IntervalOffset <= FileHeader->TrajectoryOffset && FileHeader->TrajectoryOffset <= (uint64)Size;
+	if (!bValid)
+	{
+		if (Data != nullptr)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Gait cache %s is invalid or out of date, ignoring it."), *Filename);
+		}
+		Close();
+		return false;
+	}
+
+	Header = FileHeader;
+	Index = TArrayView<const FGaitCacheIndexEntry>(reinterpret_cast<const FGaitCacheIndexEntry*>(Data + Header->IndexOffset), Header->NumEntries);
+	UE_LOG(LogTemp, Log, TEXT("Gait cache %s opened with %d entries."), *Filename, Index.Num());
+	return true;
+}
+
+void FGaitCache::Close()
+{
+	Header = nullptr;
+	Data = nullptr;
+	Index = TArrayView<const FGaitCacheIndexEntry>();
+	delete MappedRegion;
+	MappedRegion = nullptr;
+	delete MappedFile;
+	MappedFile = nullptr;
+	LoadedData.Empty();
+}
+
+bool FGaitCache::Find(const FString& AssetPath, uint64 IdentityHash, uint64 SettingsHash, FGaitCacheEntryView& OutView) const
+{
+	const FGaitCacheIndexEntry * Entry = FindEntry(AssetPath);
+	if (Entry == nullptr || Entry->IdentityHash != IdentityHash || Entry->SettingsHash != SettingsHash)
+	{
+		return false;
+	}
+	OutView = MakeView(*Entry);
+	return true;
+}
+
+bool FGaitCache::FindTrajectory(UAnimSequence* AnimSequence, const TArray<FName>& BoneNames, FFootTrajectory& OutTrajectory) const
+{
+	const FGaitCacheIndexEntry * Entry = FindEntry(AnimSequence->GetPathName());
+	if (Entry == nullptr || Entry->TrajectoryNumCurves == 0 || Entry->IdentityHash != MakeIdentityHash(AnimSequence, BoneNames))
+	{
+		return false;
+	}
+
+	// 曲线名称与采样时相同，由骨骼决定，不写入文件
+	const FCurveBakeSettings BakeSettings = FFootTrajectory::MakeBakeSettings(BoneNames);
+	const int32 NumCurves = Entry->TrajectoryNumCurves;
+	const int32 NumFrames = Entry->TrajectoryNumFrames;
+	if (BakeSettings.Requests.Num() != NumCurves)
+	{
+		return false;
+	}
+
+	FQuantizedTrajectory Quantized;
+	Quantized.BoneNames = BoneNames;
+	Quantized.NumFrames = NumFrames;
+	for (const FCurveBakeRequest & Request : BakeSettings.Requests)
+	{
+		Quantized.CurveNames.Add(Request.GetCurveName());
+	}
+	const uint8 * Source = Data + Header->TrajectoryOffset + Entry->TrajectoryOffset;
+	Quantized.Mins.Append(reinterpret_cast<const float*>(Source), NumCurves);
+	Quantized.Steps.Append(reinterpret_cast<const float*>(Source) + NumCurves, NumCurves);
+	Quantized.Values.Append(reinterpret_cast<const uint16*>(Source + NumCurves * 2 * sizeof(float)), NumCurves * NumFrames);
+	Quantized.Dequantize(AnimSequence, OutTrajectory);
+	return true;
+}
+
+const FGaitCacheIndexEntry* FGaitCache::FindEntry(const FString& AssetPath) const
+{
+	if (!IsOpen())
+	{
+		return nullptr;
+	}
+
+	const uint64 PathHash = MakePathHash(AssetPath);
+	const FTCHARToUTF8 Path(*AssetPath);
+	for (int32 i = Algo::LowerBoundBy(Index, PathHash, [](const FGaitCacheIndexEntry& Entry) { return Entry.PathHash; }); i < Index.Num() && Index[i].PathHash == PathHash; i++)
+	{
+		// 哈希相同时再比较路径
+		const FGaitCacheIndexEntry & Entry = Index[i];
+		if (!IsEntryInBounds(Entry))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Gait cache %s has a corrupt entry, ignoring it."), *Filename);
+			continue;
+		}
+		if (Entry.PathLength == (uint32)Path.Length() && FMemory::Memcmp(Data + Header->StringOffset + Entry.PathOffset, Path.Get(), Path.Length()) == 0)
+		{
+			return &Entry;
+		}
+	}
+	return nullptr;
+}
+
+bool FGaitCache::IsEntryInBounds(const FGaitCacheIndexEntry& Entry) const
+{
+	// 以64位计算，避免偏移与数量相加时溢出
+	const uint64 StringEnd = Header->StringOffset + FMath::Max<uint64>((uint64)Entry.PathOffset + Entry.PathLength, (uint64)Entry.DetectorOffset + Entry.DetectorLength);
+	const uint64 NumMarkers = (uint64)Entry.NumMarkers[0] + Entry.NumMarkers[1] + Entry.NumMarkers[2] + Entry.NumMarkers[3];
+	const uint64 MarkerEnd = Header->MarkerOffset + ((uint64)Entry.MarkerOffset + NumMarkers) * sizeof(float);
+	const uint64 IntervalEnd = Header->IntervalOffset + ((uint64)Entry.IntervalOffset + Entry.NumIntervals) * sizeof(FGaitCacheInterval);
+	const uint64 TrajectoryEnd = Header->TrajectoryOffset + Entry.TrajectoryOffset + GaitCache::GetTrajectorySize(Entry.TrajectoryNumFrames, Entry.TrajectoryNumCurves);
+	return StringEnd <= Header->MarkerOffset && MarkerEnd <= Header->IntervalOffset && IntervalEnd <= Header->TrajectoryOffset
+		&& Entry.TrajectoryOffset % 4 == 0 && TrajectoryEnd <= Header->FileSize;
+}
+
+FGaitCacheEntryView FGaitCache::MakeView(const FGaitCacheIndexEntry& Entry) const
+{
+	FGaitCacheEntryView View;
+	View.Entry = &Entry;
+	View.PathChars = reinterpret_cast<const ANSICHAR*>(Data + Header->StringOffset + Entry.PathOffset);
+	View.DetectorChars = reinterpret_cast<const ANSICHAR*>(Data + Header->StringOffset + Entry.DetectorOffset);
+
+	const float * Markers = reinterpret_cast<const float*>(Data + Header->MarkerOffset) + Entry.MarkerOffset;
+	View.LeftMarkers = TArrayView<const float>(Markers, Entry.NumMarkers[0]);
+	Markers += Entry.NumMarkers[0];
+	View.RightMarkers = TArrayView<const float>(Markers, Entry.NumMarkers[1]);
+	Markers += Entry.NumMarkers[1];
+	View.LeftLiftOffs = TArrayView<const float>(Markers, Entry.NumMarkers[2]);
+	Markers += Entry.NumMarkers[2];
+	View.RightLiftOffs = TArrayView<const float>(Markers, Entry.NumMarkers[3]);
+
+	const FGaitCacheInterval * Intervals = reinterpret_cast<const FGaitCacheInterval*>(Data + Header->IntervalOffset) + Entry.IntervalOffset;
+	View.Intervals = TArrayView<const FGaitCacheInterval>(Intervals, Entry.NumIntervals);
+	return View;
+}
+
+bool FGaitCache::Save(const TArray<const SGMarkerReference*>& References, const TArray<FName>& BoneNames)
+{
+	using namespace GaitCache;
+
+	// 新的结果
+	TArray<FWriteItem> Items;
+	TSet<FString> NewPaths;
+	for (const SGMarkerReference * Ref : References)
+	{
+		if (Ref->CacheDataHash == 0 || Ref->CacheSettingsHash == 0 || Ref->bFallbackFromDeadline)
+		{
+			continue;
+		}
+
+		FWriteItem & Item = Items.AddDefaulted_GetRef();
+		const FString Path = Ref->AnimSequence->GetPathName();
+		ToUTF8(Path, Item.Path);
+		ToUTF8(Ref->DetectorName.ToString(), Item.DetectorName);
+		Item.PathHash = MakePathHash(Path);
+		Item.DataHash = Ref->CacheDataHash;
+		Item.IdentityHash = MakeIdentityHash(Ref->AnimSequence, BoneNames);
+		Item.SettingsHash = Ref->CacheSettingsHash;
+		Item.AnalysisTicks = Ref->AnalysisTime.GetTicks();
+		Item.Tolerance = Ref->Tolerance;
+		Item.Dir = (uint8)Ref->Dir;
+		Item.bIsValid = Ref->bIsValid;
+		Item.bUsedFallback = Ref->bUsedFallback;
+		Item.Markers[0] = Ref->LeftMarkers;
+		Item.Markers[1] = Ref->RightMarkers;
+		Item.Markers[2] = Ref->LeftLiftOffs;
+		Item.Markers[3] = Ref->RightLiftOffs;
+		for (const FootInterval & Interval : Ref->Intervals)
+		{
+			FGaitCacheInterval & Out = Item.Intervals.AddZeroed_GetRef();
+			Out.Left = Interval.Left;
+			Out.Right = Interval.Right;
+			Out.bOrderIsLeftRight = Interval.IsOrderLeftRight;
+			Out.bIsWrapped = Interval.IsWrapped;
+		}
+
+		// 只有全帧率的轨迹会进入轨迹缓存，不在其中时保留文件中动画未改变的轨迹
+		FQuantizedTrajectory Quantized;
+		const FGaitCacheIndexEntry * Existing = FindEntry(Path);
+		if (FTrajectoryCache::Get().FindQuantized(Ref->AnimSequence, BoneNames, Quantized))
+		{
+			WriteTrajectory(Quantized, Item);
+		}
+		else if (Existing != nullptr && Existing->TrajectoryNumCurves > 0 && Existing->IdentityHash == Item.IdentityHash)
+		{
+			Item.TrajectoryNumFrames = Existing->TrajectoryNumFrames;
+			Item.TrajectoryNumCurves = Existing->TrajectoryNumCurves;
+			Item.Trajectory.Append(Data + Header->TrajectoryOffset + Existing->TrajectoryOffset, (int32)GetTrajectorySize(Existing->TrajectoryNumFrames, Existing->TrajectoryNumCurves));
+		}
+		NewPaths.Add(Path);
+	}
+
+	// 保留缓存中没有被新结果替换的项，数据直接引用映射内存
+	for (const FGaitCacheIndexEntry & Entry : Index)
+	{
+		if (!IsEntryInBounds(Entry))
+		{
+			continue;
+		}
+		const FGaitCacheEntryView View = MakeView(Entry);
+		if (NewPaths.Contains(View.GetPath()))
+		{
+			continue;
+		}
+
+		FWriteItem & Item = Items.AddDefaulted_GetRef();
+		Item.Path.Append(View.PathChars, Entry.PathLength);
+		Item.DetectorName.Append(View.DetectorChars, Entry.DetectorLength);
+		Item.PathHash = Entry.PathHash;
+		Item.DataHash = Entry.DataHash;
+		Item.IdentityHash = Entry.IdentityHash;
+		Item.SettingsHash = Entry.SettingsHash;
+		Item.AnalysisTicks = Entry.AnalysisTicks;
+		Item.Tolerance = Entry.Tolerance;
+		Item.Dir = Entry.Dir;
+		Item.bIsValid = Entry.bIsValid;
+		Item.bUsedFallback = Entry.bUsedFallback;
+		Item.Markers[0] = View.LeftMarkers;
+		Item.Markers[1] = View.RightMarkers;
+		Item.Markers[2] = View.LeftLiftOffs;
+		Item.Markers[3] = View.RightLiftOffs;
+		Item.Intervals.Append(View.Intervals.GetData(), View.Intervals.Num());
+		Item.TrajectoryNumFrames = Entry.TrajectoryNumFrames;
+		Item.TrajectoryNumCurves = Entry.TrajectoryNumCurves;
+		Item.Trajectory.Append(Data + Header->TrajectoryOffset + Entry.TrajectoryOffset, (int32)GetTrajectorySize(Entry.TrajectoryNumFrames, Entry.TrajectoryNumCurves));
+	}
+
+	Items.Sort([](const FWriteItem& A, const FWriteItem& B) { return A.PathHash < B.PathHash; });
+
+	// 计算各段的位置
+	uint64 NumStringBytes = 0, NumMarkers = 0, NumIntervals = 0, NumTrajectoryBytes = 0;
+	for (const FWriteItem & Item : Items)
+	{
+		NumStringBytes += Item.Path.Num() + Item.DetectorName.Num();
+		for (const TArrayView<const float> & Markers : Item.Markers)
+		{
+			NumMarkers += Markers.Num();
+		}
+		NumIntervals += Item.Intervals.Num();
+		NumTrajectoryBytes += Item.Trajectory.Num();
+	}
+
+	FGaitCacheHeader NewHeader;
+	FMemory::Memzero(NewHeader);
+	NewHeader.Magic = Magic;
+	NewHeader.Version = Version;
+	NewHeader.NumEntries = Items.Num();
+	NewHeader.IndexOffset = Align(sizeof(FGaitCacheHeader), 8);
+	NewHeader.StringOffset = NewHeader.IndexOffset + Items.Num() * sizeof(FGaitCacheIndexEntry);
+	NewHeader.MarkerOffset = Align(NewHeader.StringOffset + NumStringBytes, 8);
+	NewHeader.IntervalOffset = Align(NewHeader.MarkerOffset + NumMarkers * sizeof(float), 8);
+	NewHeader.TrajectoryOffset = Align(NewHeader.IntervalOffset + NumIntervals * sizeof(FGaitCacheInterval), 8);
+	NewHeader.FileSize = NewHeader.TrajectoryOffset + NumTrajectoryBytes;
+
+	TArray<uint8> Bytes;
+	Bytes.SetNumZeroed(NewHeader.FileSize);
+	FMemory::Memcpy(Bytes.GetData(), &NewHeader, sizeof(NewHeader));
+
+	FGaitCacheIndexEntry * Entries = reinterpret_cast<FGaitCacheIndexEntry*>(Bytes.GetData() + NewHeader.IndexOffset);
+	uint32 StringCursor = 0, MarkerCursor = 0, IntervalCursor = 0, TrajectoryCursor = 0;
+	for (int32 i = 0; i < Items.Num(); i++)
+	{
+		const FWriteItem & Item = Items[i];
+		FGaitCacheIndexEntry & Entry = Entries[i];
+		Entry.PathHash = Item.PathHash;
+		Entry.DataHash = Item.DataHash;
+		Entry.IdentityHash = Item.IdentityHash;
+		Entry.SettingsHash = Item.SettingsHash;
+		Entry.AnalysisTicks = Item.AnalysisTicks;
+		Entry.Tolerance = Item.Tolerance;
+		Entry.Dir = Item.Dir;
+		Entry.bIsValid = Item.bIsValid;
+		Entry.bUsedFallback = Item.bUsedFallback;
+
+		Entry.PathOffset = StringCursor;
+		Entry.PathLength = Item.Path.Num();
+		FMemory::Memcpy(Bytes.GetData() + NewHeader.StringOffset + StringCursor, Item.Path.GetData(), Item.Path.Num());
+		StringCursor += Item.Path.Num();
+		Entry.DetectorOffset = StringCursor;
+		Entry.DetectorLength = Item.DetectorName.Num();
+		FMemory::Memcpy(Bytes.GetData() + NewHeader.StringOffset + StringCursor, Item.DetectorName.GetData(), Item.DetectorName.Num());
+		StringCursor += Item.DetectorName.Num();
+
+		Entry.MarkerOffset = MarkerCursor;
+		for (int32 k = 0; k < 4; k++)
+		{
+			Entry.NumMarkers[k] = Item.Markers[k].Num();
+			FMemory::Memcpy(Bytes.GetData() + NewHeader.MarkerOffset + MarkerCursor * sizeof(float), Item.Markers[k].GetData(), Item.Markers[k].Num() * sizeof(float));
+			MarkerCursor += Item.Markers[k].Num();
+		}
+
+		Entry.IntervalOffset = IntervalCursor;
+		Entry.NumIntervals = Item.Intervals.Num();
+		FMemory::Memcpy(Bytes.GetData() + NewHeader.IntervalOffset + IntervalCursor * sizeof(FGaitCacheInterval), Item.Intervals.GetData(), Item.Intervals.Num() * sizeof(FGaitCacheInterval));
+		IntervalCursor += Item.Intervals.Num();
+
+		Entry.TrajectoryOffset = TrajectoryCursor;
+		Entry.TrajectoryNumFrames = Item.TrajectoryNumFrames;
+		Entry.TrajectoryNumCurves = Item.TrajectoryNumCurves;
+		FMemory::Memcpy(Bytes.GetData() + NewHeader.TrajectoryOffset + TrajectoryCursor, Item.Trajectory.GetData(), Item.Trajectory.Num());
+		TrajectoryCursor += Item.Trajectory.Num();
+	}
+
+	// 写入前解除映射，之后重新映射新文件
+	const FString SaveFilename = Filename.IsEmpty() ? GetDefaultFilename() : Filename;
+	Close();
+	const bool bSaved = FFileHelper::SaveArrayToFile(Bytes, *SaveFilename);
+	if (!bSaved)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Failed to write gait cache %s."), *SaveFilename);
+	}
+	Open(SaveFilename);
+	return bSaved;
+}
+
+uint64 FGaitCache::MakePathHash(const FString& AssetPath)
+{
+	const FTCHARToUTF8 Path(*AssetPath);
+	return CityHash64(Path.Get(), Path.Length());
+}
+
+uint64 FGaitCache::MakeIdentityHash(UAnimSequence* AnimSequence, const TArray<FName>& BoneNames)
+{
+	// 与轨迹缓存的键相同，原始轨道数据改变时GUID随之改变
+	FString Key = FString::Printf(TEXT("%s|%d|%.6f"), *AnimSequence->GetRawDataGuid().ToString(), AnimSequence->GetNumberOfFrames(), AnimSequence->GetPlayLength());
+	for (FName BoneName : BoneNames)
+	{
+		Key += TEXT("|") + BoneName.ToString();
+	}
+	const FTCHARToUTF8 Converted(*Key);
+	return CityHash64(Converted.Get(), Converted.Length());
+}
+
+FSHAHash FGaitCache::MakeContentHash(UAnimSequence* AnimSequence, const TArray<FName>& BoneNames)
+{
+	FSHA1 Sha;
+	const int32 NumFrames = AnimSequence->GetNumberOfFrames();
+	const float Length = AnimSequence->GetPlayLength();
+	Sha.Update(reinterpret_cast<const uint8*>(&NumFrames), sizeof(NumFrames));
+	Sha.Update(reinterpret_cast<const uint8*>(&Length), sizeof(Length));
+
+	// 骨骼链上的所有骨骼，按索引排序使哈希与骨骼输入顺序无关
+	const FReferenceSkeleton & RefSkeleton = AnimSequence->GetSkeleton()->GetReferenceSkeleton();
+	TArray<int32> ChainBones;
+	for (FName BoneName : BoneNames)
+	{
+		for (int32 BoneIndex = RefSkeleton.FindBoneIndex(BoneName); BoneIndex != INDEX_NONE; BoneIndex = RefSkeleton.GetParentIndex(BoneIndex))
+		{
+			ChainBones.AddUnique(BoneIndex);
+		}
+	}
+	ChainBones.Sort();
+
+	const TArray<FTrackToSkeletonMap> & TrackMap = AnimSequence->GetRawTrackToSkeletonMapTable();
+	const TArray<FRawAnimSequenceTrack> & RawTracks = AnimSequence->GetRawAnimationData();
+	for (int32 BoneIndex : ChainBones)
+	{
+		const FString BoneName = RefSkeleton.GetBoneName(BoneIndex).ToString();
+		Sha.UpdateWithString(*BoneName, BoneName.Len());
+
+		// 没有轨道的骨骼使用参考姿势
+		const FTransform & RefPose = RefSkeleton.GetRefBonePose()[BoneIndex];
+		const FVector Location = RefPose.GetLocation();
+		const FQuat Rotation = RefPose.GetRotation();
+		const FVector Scale = RefPose.GetScale3D();
+		Sha.Update(reinterpret_cast<const uint8*>(&Location), sizeof(Location));
+		Sha.Update(reinterpret_cast<const uint8*>(&Rotation), sizeof(Rotation));
+		Sha.Update(reinterpret_cast<const uint8*>(&Scale), sizeof(Scale));
+
+		const int32 TrackIndex = FAnimCurveToolModule::GetAnimTrackIndexForSkeletonBone(BoneIndex, TrackMap);
+		if (RawTracks.IsValidIndex(TrackIndex))
+		{
+			// 每段数据前写入数量，避免不同的分段得到相同的字节流
+			const FRawAnimSequenceTrack & Track = RawTracks[TrackIndex];
+			const int32 Counts[3] = { Track.PosKeys.Num(), Track.RotKeys.Num(), Track.ScaleKeys.Num() };
+			Sha.Update(reinterpret_cast<const uint8*>(Counts), sizeof(Counts));
+			Sha.Update(reinterpret_cast<const uint8*>(Track.PosKeys.GetData()), Track.PosKeys.Num() * sizeof(FVector));
+			Sha.Update(reinterpret_cast<const uint8*>(Track.RotKeys.GetData()), Track.RotKeys.Num() * sizeof(FQuat));
+			Sha.Update(reinterpret_cast<const uint8*>(Track.ScaleKeys.GetData()), Track.ScaleKeys.Num() * sizeof(FVector));
+		}
+	}
+
+	Sha.Final();
+	FSHAHash Hash;
+	Sha.GetHash(Hash.Hash);
+	return Hash;
+}
+
+uint64 FGaitCache::MakeSettingsHash(FName LeftFoot, FName RightFoot, FName DetectorName, const FContactDetectorSettings& Settings)
+{
+	// 影响分析结果的设置
+	const FString Key = FString::Printf(TEXT("%s|%s|%s|%.4f|%.4f|%.4f|%.4f|%.4f|%.4f|%d|%d|%d|%d|%.4f|%d|%.4f|%s"),
+		*LeftFoot.ToString(), *RightFoot.ToString(), *DetectorName.ToString(),
+		Settings.HeightTolerance, Settings.TurningDescentThreshold,
+		Settings.PlantSpeedThreshold, Settings.ReleaseSpeedThreshold, Settings.PlantHeightRatio, Settings.ReleaseHeightRatio,
+		Settings.bSubFrameRefine ? 1 : 0, Settings.AnalysisStride, Settings.RefineWindowStrides, Settings.MaxSearchFrames, Settings.TimeBudget,
+		Settings.MirrorProbeFrames, Settings.MirrorTolerance, *Settings.FallbackDetectorName.ToString());
+	const FTCHARToUTF8 Converted(*Key);
+
+	// 0保留为“不缓存”
+	const uint64 Hash = CityHash64(Converted.Get(), Converted.Length());
+	return Hash != 0 ? Hash : 1;
+}
+
+uint64 FGaitCache::MakeDataHash(const FSHAHash& ContentHash, uint8 Dir, uint64 SettingsHash)
+{
+	// 影响分析结果的动画内容、方向标签与设置
+	const FString Key = FString::Printf(TEXT("%s|%d|%llu"), *ContentHash.ToString(), Dir, SettingsHash);
+	const FTCHARToUTF8 Converted(*Key);
+
+	// 0保留为“不缓存”
+	const uint64 Hash = CityHash64(Converted.Get(), Converted.Length());
+	return Hash != 0 ? Hash : 1;
+}
@@ -0,0 +1,220 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "AnimCurveToolGaitCurves.h"
+
+#include "AnimCurveTool.h"
+#include "AnimCurveToolCurveBaker.h"
+#include "GaitTableUserData.h"
+
+const FName FGaitCurveBaker::LeftContactCurveName("LeftFootContact");
+const FName FGaitCurveBaker::RightContactCurveName("RightFootContact");
+const FName FGaitCurveBaker::LeftLockCurveName("LeftFootLock");
+const FName FGaitCurveBaker::RightLockCurveName("RightFootLock");
+const FName FGaitCurveBaker::PhaseCurveName("GaitPhase");
+
+bool FGaitCurveBaker::MakeFootCurves(const SGMarkerReference& Reference, const FGaitCurveSettings& Settings, FCurveBakeResult& OutResult)
+{
+	UAnimSequence * AnimSequence = Reference.AnimSequence;
+	OutResult.AnimSequence = AnimSequence;
+	OutResult.bIsValid = false;
+	OutResult.CurveNames.Reset();
+
+	if (!Reference.bIsValid || Reference.LeftLiftOffs.Num() == 0 || Reference.RightLiftOffs.Num() == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("No valid contact or lift-off data for %s, foot curves skipped."), *AnimSequence->GetName());
+		return false;
+	}
+
+	const float Length = AnimSequence->GetPlayLength();
+	TArray<FVector2D> LeftStances, RightStances;
+	GetStanceIntervals(Reference.LeftMarkers, Reference.LeftLiftOffs, Length, LeftStances);
+	GetStanceIntervals(Reference.RightMarkers, Reference.RightLiftOffs, Length, RightStances);
+
+	const int32 NumFrames = AnimSequence->GetNumberOfFrames();
+	OutResult.NumFrames = NumFrames;
+	OutResult.Times.SetNumUninitialized(NumFrames);
+	for (int32 Frame = 0; Frame < NumFrames; Frame++)
+	{
+		OutResult.Times[Frame] = AnimSequence->GetTimeAtFrame(Frame);
+	}
+
+	OutResult.CurveNames.Add(LeftContactCurveName);
+	OutResult.CurveNames.Add(RightContactCurveName);
+	OutResult.CurveNames.Add(LeftLockCurveName);
+	OutResult.CurveNames.Add(RightLockCurveName);
+	OutResult.Values.SetNumUninitialized(NumFrames * OutResult.CurveNames.Num());
+
+	SampleStanceWeights(LeftStances, Settings.ContactBlendTime, false, Length, OutResult.Times, OutResult.Values.GetData());
+	SampleStanceWeights(RightStances, Settings.ContactBlendTime, false, Length, OutResult.Times, OutResult.Values.GetData() + NumFrames);
+	SampleStanceWeights(LeftStances, Settings.LockBlendTime, true, Length, OutResult.Times, OutResult.Values.GetData() + 2 * NumFrames);
+	SampleStanceWeights(RightStances, Settings.LockBlendTime, true, Length, OutResult.Times, OutResult.Values.GetData() + 3 * NumFrames);
+
+	OutResult.bIsValid = true;
+	return true;
+}
+
+bool FGaitCurveBaker::MakePhaseCurve(const SGMarkerReference& Reference, EGaitPhaseMode Mode, FBakedCurve& OutCurve)
+{
+	OutCurve.Name = PhaseCurveName;
+	OutCurve.Keys.Reset();
+	if (!Reference.bIsValid || Reference.Intervals.Num() == 0)
+	{
+		return false;
+	}
+
+	struct FPhaseSegment
+	{
+		float Start, End, StartPhase, EndPhase;
+	};
+
+	// 将每个区间转换为动画时间轴上的线性段，跨越循环的区间在动画末尾拆为两段
+	const float Length = Reference.AnimSequence->GetPlayLength();
+	TArray<FPhaseSegment> Segments;
+	for (const FootInterval & Interval : Reference.Intervals)
+	{
+		float StartPhase = 0.f;
+		float EndPhase = 1.f;
+		if (Mode == EGaitPhaseMode::Stride)
+		{
+			StartPhase = Interval.IsOrderLeftRight ? 0.f : 0.5f;
+			EndPhase = StartPhase + 0.5f;
+		}
+
+		if (!Interval.IsWrapped)
+		{
+			Segments.Add({ Interval.Left, Interval.Right, StartPhase, EndPhase });
+		}
+		else
+		{
+			const float Span = Interval.Right + Length - Interval.Left;
+			const float MidPhase = Span > 0.f ? StartPhase + (EndPhase - StartPhase) * (Length - Interval.Left) / Span : StartPhase;
+			Segments.Add({ Interval.Left, Length, StartPhase, MidPhase });
+			Segments.Add({ 0.f, Interval.Right, MidPhase, EndPhase });
+		}
+	}
+	Segments.Sort([](const FPhaseSegment& A, const FPhaseSegment& B) { return A.Start < B.Start; });
+
+	auto AddKey = [&OutCurve](float Time, float Value)
+	{
+		FRichCurveKey & Key = OutCurve.Keys.Emplace_GetRef(Time, Value);
+		Key.InterpMode = RCIM_Linear;
+	};
+
+	for (const FPhaseSegment & Segment : Segments)
+	{
+		if (Segment.End - Segment.Start <= KINDA_SMALL_NUMBER)
+		{
+			continue;
+		}
+
+		if (OutCurve.Keys.Num() > 0)
+		{
+			FRichCurveKey & LastKey = OutCurve.Keys.Last();
+			if (FMath::IsNearlyEqual(LastKey.Time, Segment.Start, KINDA_SMALL_NUMBER))
+			{
+				if (FMath::IsNearlyEqual(LastKey.Value, Segment.StartPhase))
+				{
+					// 相位连续，共用边界上的关键帧
+					AddKey(Segment.End, Segment.EndPhase);
+					continue;
+				}
+				// 相位回到0，前一段的末尾提前一点，形成陡降
+				const float PrevTime = OutCurve.Keys.Num() > 1 ? OutCurve.Keys[OutCurve.Keys.Num() - 2].Time : 0.f;
+				LastKey.Time = FMath::Max(Segment.Start - PhaseWrapGap, 0.5f * (PrevTime + Segment.Start));
+			}
+		}
+		AddKey(Segment.Start, Segment.StartPhase);
+		AddKey(Segment.End, Segment.EndPhase);
+	}
+
+	OutCurve.NumSamples = Reference.AnimSequence->GetNumberOfFrames();
+	return OutCurve.Keys.Num() > 0;
+}
+
+void FGaitCurveBaker::MakeGaitTableIntervals(const SGMarkerReference& Reference, TArray<FGaitTableInterval>& OutIntervals)
+{
+	UAnimSequence * AnimSequence = Reference.AnimSequence;
+	const float Length = AnimSequence->GetPlayLength();
+
+	OutIntervals.Reset(Reference.Intervals.Num());
+	for (const FootInterval & Interval : Reference.Intervals)
+	{
+		FGaitTableInterval & Out = OutIntervals.AddDefaulted_GetRef();
+		Out.Start = Interval.Left;
+		Out.End = Interval.Right + (Interval.IsWrapped ? Length : 0.f);
+		Out.bOrderIsLeftRight = Interval.IsOrderLeftRight;
+
+		const float Span = Out.End - Out.Start;
+		if (Span > KINDA_SMALL_NUMBER)
+		{
+			Out.Speed = AnimSequence->ExtractRootMotion(Out.Start, Span, true).GetTranslation().Size2D() / Span;
+		}
+	}
+}
+
+void FGaitCurveBaker::GetStanceIntervals(const TArray<float>& Contacts, const TArray<float>& LiftOffs, float Length, TArray<FVector2D>& OutStances)
+{
+	OutStances.Reset(Contacts.Num());
+	if (LiftOffs.Num() == 0)
+	{
+		return;
+	}
+
+	// 离地点已排序，找到落地后的第一个离地点，找不到时为下一个循环的第一个离地点
+	for (float Contact : Contacts)
+	{
+		float LiftOff = LiftOffs[0] + Length;
+		for (float Time : LiftOffs)
+		{
+			if (Time > Contact)
+			{
+				LiftOff = Time;
+				break;
+			}
+		}
+		OutStances.Add(FVector2D(Contact, LiftOff));
+	}
+}
+
+float FGaitCurveBaker::GetTrapezoidWeight(float Time, float Start, float End, float Ramp)
+{
+	if (Time >= Start && Time <= End)
+	{
+		return 1.f;
+	}
+	if (Ramp <= 0.f)
+	{
+		return 0.f;
+	}
+
+	const float Distance = Time < Start ? Start - Time : Time - End;
+	return FMath::Max(0.f, 1.f - Distance / Ramp);
+}
+
+void FGaitCurveBaker::SampleStanceWeights(const TArray<FVector2D>& Stances, float Ramp, bool bInside, float Length, const TArray<float>& Times, float* OutValues)
+{
+	for (int32 Frame = 0; Frame < Times.Num(); Frame++)
+	{
+		float Weight = 0.f;
+		for (const FVector2D & Stance : Stances)
+		{
+			float Start = Stance.X;
+			float End = Stance.Y;
+			float StanceRamp = Ramp;
+			if (bInside)
+			{
+				// 锁脚在站立区间内部过渡，区间过短时在中点达到最大值
+				StanceRamp = FMath::Min(Ramp, 0.5f * (End - Start));
+				Start += StanceRamp;
+				End -= StanceRamp;
+			}
+
+			// 区间可能跨越循环，前后两个循环都需要考虑
+			const float Time = Times[Frame];
+			Weight = FMath::Max(Weight, GetTrapezoidWeight(Time, Start, End, StanceRamp));
+			Weight = FMath::Max(Weight, GetTrapezoidWeight(Time + Length, Start, End, StanceRamp));
+			Weight = FMath::Max(Weight, GetTrapezoidWeight(Time - Length, Start, End, StanceRamp));
+		}
+		OutValues[Frame] = Weight;
+	}
+}
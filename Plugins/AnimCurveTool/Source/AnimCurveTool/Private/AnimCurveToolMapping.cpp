@@ -0,0 +1,101 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "AnimCurveToolMapping.h"
+
+#include "AnimCurveTool.h"
+#include "Async/ParallelFor.h"
+#include "Math/VectorRegister.h"
+
+void FGaitIntervalTable::Build(const TArray<const SGMarkerReference*>& Targets)
+{
+	NumTargets = Targets.Num();
+
+	int32 Counts[2] = { 0, 0 };
+	for (const SGMarkerReference * Target : Targets)
+	{
+		for (const FootInterval & Interval : Target->Intervals)
+		{
+			Counts[Interval.IsOrderLeftRight ? 1 : 0]++;
+		}
+	}
+
+	for (int32 Order = 0; Order < 2; Order++)
+	{
+		FOrderTable & Table = Tables[Order];
+		const int32 Padded = Align(Counts[Order], 4);
+		Table.NumIntervals = Counts[Order];
+		Table.Left.Reset(Padded);
+		Table.Span.Reset(Padded);
+		Table.Length.Reset(Padded);
+		Table.TargetOffsets.Reset(NumTargets + 1);
+	}
+
+	for (const SGMarkerReference * Target : Targets)
+	{
+		const float Len = Target->AnimSequence->GetPlayLength();
+		Tables[0].TargetOffsets.Add(Tables[0].Left.Num());
+		Tables[1].TargetOffsets.Add(Tables[1].Left.Num());
+
+		for (const FootInterval & Interval : Target->Intervals)
+		{
+			FOrderTable & Table = Tables[Interval.IsOrderLeftRight ? 1 : 0];
+			Table.Left.Add(Interval.Left);
+			// 区间横跨了两个动画循环的情况，右界加上循环长度
+			Table.Span.Add(Interval.Right - Interval.Left + (Interval.IsWrapped ? Len : 0.f));
+			Table.Length.Add(Len);
+		}
+	}
+
+	for (int32 Order = 0; Order < 2; Order++)
+	{
+		FOrderTable & Table = Tables[Order];
+		Table.TargetOffsets.Add(Table.Left.Num());
+
+		// 补齐到4的倍数，内核不需要处理尾部
+		const int32 Padded = Align(Table.NumIntervals, 4);
+		Table.Left.SetNumZeroed(Padded);
+		Table.Span.SetNumZeroed(Padded);
+		Table.Length.SetNumZeroed(Padded);
+	}
+}
+
+void FBatchedRatioMapper::MapRatios(const FGaitIntervalTable& Table, TArrayView<const float> Ratios, TArrayView<const bool> Orders, TArray<float>& OutTimes, TArray<int32>& OutEventOffsets)
+{
+	check(Ratios.Num() == Orders.Num());
+
+	// 先确定每个比例的输出位置，一次分配全部输出
+	OutEventOffsets.Reset(Ratios.Num());
+	int32 Total = 0;
+	for (int32 EventIndex = 0; EventIndex < Ratios.Num(); EventIndex++)
+	{
+		OutEventOffsets.Add(Total);
+		Total += Table.GetTable(Orders[EventIndex]).NumPadded();
+	}
+	OutTimes.Reset(Total);
+	OutTimes.AddUninitialized(Total);
+
+	float * OutData = OutTimes.GetData();
+	ParallelFor(Ratios.Num(), [&](int32 EventIndex)
+	{
+		MapRatio(Table.GetTable(Orders[EventIndex]), Ratios[EventIndex], OutData + OutEventOffsets[EventIndex]);
+	}, Ratios.Num() < 8);
+}
+
+void FBatchedRatioMapper::MapRatio(const FGaitIntervalTable::FOrderTable& Table, float Ratio, float* Out)
+{
+	const float * Left = Table.Left.GetData();
+	const float * Span = Table.Span.GetData();
+	const float * Length = Table.Length.GetData();
+	const VectorRegister VRatio = VectorSetFloat1(Ratio);
+	const VectorRegister VZero = VectorZero();
+
+	for (int32 i = 0; i < Table.NumPadded(); i += 4)
+	{
+		const VectorRegister VLength = VectorLoad(Length + i);
+		const VectorRegister VTime = VectorMultiplyAdd(VectorLoad(Span + i), VRatio, VectorLoad(Left + i));
+
+		// 超过动画长度的结果落在下一个循环，减去一个长度；未跨越循环的区间不会超过长度
+		const VectorRegister VWrap = VectorSelect(VectorCompareGT(VTime, VLength), VLength, VZero);
+		VectorStore(VectorSubtract(VTime, VWrap), Out + i);
+	}
+}
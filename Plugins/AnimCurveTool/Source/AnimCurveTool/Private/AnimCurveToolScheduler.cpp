@@ -0,0 +1,81 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "AnimCurveToolScheduler.h"
+
+#include "Animation/AnimSequence.h"
+#include "Animation/Skeleton.h"
+#include "Async/ParallelFor.h"
+#include "HAL/ThreadSafeCounter.h"
+
+int64 FBatchScheduler::EstimateCost(UAnimSequence* AnimSequence, const TArray<FName>& BoneNames, bool bRootRelative)
+{
+	const FReferenceSkeleton & RefSkeleton = AnimSequence->GetSkeleton()->GetReferenceSkeleton();
+
+	// 所有骨骼链的并集，每帧每个骨骼只计算一次
+	TArray<int32> ChainBones;
+	for (FName BoneName : BoneNames)
+	{
+		int32 BoneIndex = RefSkeleton.FindBoneIndex(BoneName);
+		while (BoneIndex != INDEX_NONE)
+		{
+			ChainBones.AddUnique(BoneIndex);
+			BoneIndex = bRootRelative ? RefSkeleton.GetParentIndex(BoneIndex) : INDEX_NONE;
+		}
+	}
+	return int64(AnimSequence->GetNumberOfFrames()) * FMath::Max(1, ChainBones.Num());
+}
+
+void FBatchScheduler::MakeJobs(TArrayView<const int64> Costs, TArrayView<const int32> NumFrames, bool bSplittable, TArray<FBatchJob>& OutJobs)
+{
+	check(Costs.Num() == NumFrames.Num());
+	OutJobs.Reset();
+
+	int64 TotalCost = 0;
+	for (int64 Cost : Costs)
+	{
+		TotalCost += Cost;
+	}
+
+	// 单个任务不超过每个线程平均份额的一半，最后一批任务可以填满各线程的空闲
+	const int64 MaxJobCost = FMath::Max<int64>(1, TotalCost / (GetNumWorkers() * 2));
+	for (int32 Item = 0; Item < Costs.Num(); Item++)
+	{
+		int32 NumParts = 1;
+		if (bSplittable && Costs[Item] > MaxJobCost)
+		{
+			NumParts = (int32)FMath::Min<int64>((Costs[Item] + MaxJobCost - 1) / MaxJobCost, FMath::Max(1, NumFrames[Item] / MinSplitFrames));
+		}
+
+		const int32 PartFrames = FMath::Max(1, FMath::DivideAndRoundUp(NumFrames[Item], NumParts));
+		for (int32 Part = 0; Part < NumParts; Part++)
+		{
+			FBatchJob & Job = OutJobs.AddDefaulted_GetRef();
+			Job.Item = Item;
+			Job.FrameBegin = FMath::Min(NumFrames[Item], Part * PartFrames);
+			Job.FrameEnd = Part == NumParts - 1 ? NumFrames[Item] : FMath::Min(NumFrames[Item], Job.FrameBegin + PartFrames);
+			Job.Cost = NumParts > 1 ? Costs[Item] * (Job.FrameEnd - Job.FrameBegin) / NumFrames[Item] : Costs[Item];
+		}
+	}
+
+	// 最长的任务最先开始
+	OutJobs.Sort([](const FBatchJob& A, const FBatchJob& B) { return A.Cost > B.Cost; });
+}
+
+void FBatchScheduler::Run(const TArray<FBatchJob>& Jobs, TFunctionRef<void(const FBatchJob&)> Work)
+{
+	const int32 NumWorkers = FMath::Min(GetNumWorkers(), Jobs.Num());
+	FThreadSafeCounter NextJob;
+	ParallelFor(NumWorkers, [&](int32 Worker)
+	{
+		for (int32 JobIndex = NextJob.Increment() - 1; JobIndex < Jobs.Num(); JobIndex = NextJob.Increment() - 1)
+		{
+			Work(Jobs[JobIndex]);
+		}
+	}, NumWorkers <= 1);
+}
+
+int32 FBatchScheduler::GetNumWorkers()
+{
+	// 工作线程加上调用线程
+	return FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads() + 1);
+}
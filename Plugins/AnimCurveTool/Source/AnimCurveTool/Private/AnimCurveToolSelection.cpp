@@ -0,0 +1,105 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "AnimCurveToolSelection.h"
+
+bool FAnimSelection::Add(UAnimSequence* AnimSequence)
+{
+	bool bAlreadyInSet = false;
+	Lookup.Add(AnimSequence, &bAlreadyInSet);
+	if (bAlreadyInSet)
+	{
+		return false;
+	}
+	Items.Add(AnimSequence);
+	return true;
+}
+
+void FAnimSelection::Reset()
+{
+	Items.Reset();
+	Lookup.Reset();
+}
+
+void FAnimSelection::Reserve(int32 Number)
+{
+	Items.Reserve(Number);
+	Lookup.Reserve(Number);
+}
+
+bool FAnimNameRule::Matches(const FString& AnimName) const
+{
+	if (bIsRegex)
+	{
+		FRegexMatcher Matcher(*Regex, AnimName);
+		return Matcher.FindNext();
+	}
+	return AnimName.MatchesWildcard(Pattern, ESearchCase::CaseSensitive);
+}
+
+void FAnimNameFilter::Compile(const FString& InPrefix, const FString& InPostfix, const FString& InRules)
+{
+	Prefix = InPrefix;
+	Postfix = InPostfix;
+	IncludeRules.Reset();
+	ExcludeRules.Reset();
+
+	TArray<FString> RuleStrings;
+	InRules.ParseIntoArray(RuleStrings, TEXT(";"), true);
+	for (FString & RuleString : RuleStrings)
+	{
+		RuleString.TrimStartAndEndInline();
+
+		FAnimNameRule Rule;
+		if (RuleString.StartsWith(TEXT("-")))
+		{
+			Rule.bInclude = false;
+			RuleString.RightChopInline(1, false);
+		}
+		else if (RuleString.StartsWith(TEXT("+")))
+		{
+			RuleString.RightChopInline(1, false);
+		}
+
+		if (RuleString.StartsWith(TEXT("re:")))
+		{
+			Rule.bIsRegex = true;
+			RuleString.RightChopInline(3, false);
+		}
+
+		if (RuleString.Len() == 0)
+		{
+			continue;
+		}
+
+		Rule.Pattern = RuleString;
+		if (Rule.bIsRegex)
+		{
+			Rule.Regex = MakeShared<FRegexPattern>(Rule.Pattern);
+		}
+
+		(Rule.bInclude ? IncludeRules : ExcludeRules).Add(MoveTemp(Rule));
+	}
+}
+
+bool FAnimNameFilter::PassesFilter(const FString& AnimName) const
+{
+	if (Prefix.Len() != 0 && !AnimName.StartsWith(Prefix, ESearchCase::CaseSensitive))
+	{
+		return false;
+	}
+	if (Postfix.Len() != 0 && !AnimName.EndsWith(Postfix, ESearchCase::CaseSensitive))
+	{
+		return false;
+	}
+
+	if (IncludeRules.Num() > 0)
+	{
+		const bool bIncluded = IncludeRules.ContainsByPredicate([&AnimName](const FAnimNameRule& Rule) { return Rule.Matches(AnimName); });
+		if (!bIncluded)
+		{
+			return false;
+		}
+	}
+
+	return !ExcludeRules.ContainsByPredicate([&AnimName](const FAnimNameRule& Rule) { return Rule.Matches(AnimName); });
+}
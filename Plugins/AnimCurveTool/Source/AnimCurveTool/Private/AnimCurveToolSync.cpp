@@ -0,0 +1,113 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "AnimCurveToolSync.h"
+
+#include "AnimCurveTool.h"
+#include "Async/ParallelFor.h"
+#include "Misc/MemStack.h"
+
+bool FReferenceGroupSync::CollectEvents(const SGMarkerReference& Reference, FName TrackName, TArray<FSyncSourceEvent>& OutEvents)
+{
+	UAnimSequence * RefAnimSequence = Reference.AnimSequence;
+	const int32 TrackIndex = FAnimCurveToolModule::GetTrackIndexForAnimationNotifyTrackName(RefAnimSequence, TrackName);
+	if (TrackIndex == INDEX_NONE)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Track %s not found in animation %s."), *TrackName.ToString(), *RefAnimSequence->GetName());
+		return false;
+	}
+
+	// 记录所有的同步标记，并将时间换算为标记区间上的比例（唯一值）
+	for (const FAnimSyncMarker & m : RefAnimSequence->AuthoredSyncMarkers)
+	{
+		if (m.TrackIndex == TrackIndex)
+		{
+			FSyncSourceEvent & Event = OutEvents.AddDefaulted_GetRef();
+			Event.TrackName = TrackName;
+			Event.MarkerName = m.MarkerName;
+			Reference.GetRatioFromTime(m.Time, Event.RefRatio, Event.bOrderIsLeftRight);
+		}
+	}
+
+	// 记录所有的通知
+	for (const FAnimNotifyEvent & e : RefAnimSequence->Notifies)
+	{
+		if (e.TrackIndex == TrackIndex)
+		{
+			FSyncSourceEvent & Event = OutEvents.AddDefaulted_GetRef();
+			Event.TrackName = TrackName;
+			Event.bIsNotify = true;
+			Event.NotifyClass = e.Notify ? e.Notify->GetClass() : nullptr;
+			Reference.GetRatioFromTime(e.GetTime(), Event.RefRatio, Event.bOrderIsLeftRight);
+		}
+	}
+	return true;
+}
+
+void FReferenceGroupSync::PlanTargets(const TArray<FSyncSourceEvent>& Events, const TArray<const SGMarkerReference*>& Targets, TArray<FSyncTargetPlan>& OutPlans)
+{
+	OutPlans.Reset();
+	OutPlans.SetNum(Targets.Num());
+
+	// 所有目标的区间平铺为连续的表，所有比例一次映射为时间
+	FGaitIntervalTable Table;
+	Table.Build(Targets);
+
+	// 映射的输入只在本次规划中使用，从临时内存栈分配
+	FMemMark Mark(FMemStack::Get());
+	TArray<float, TMemStackAllocator<>> Ratios;
+	TArray<bool, TMemStackAllocator<>> Orders;
+	Ratios.Reserve(Events.Num());
+	Orders.Reserve(Events.Num());
+	for (const FSyncSourceEvent & Event : Events)
+	{
+		Ratios.Add(Event.RefRatio);
+		Orders.Add(Event.bOrderIsLeftRight);
+	}
+
+	TArray<float> MappedTimes;
+	TArray<int32> EventOffsets;
+	FBatchedRatioMapper::MapRatios(Table, Ratios, Orders, MappedTimes, EventOffsets);
+
+	// 每个目标只读取映射结果中属于自己的部分并写入自己的结果，不需要加锁
+	ParallelFor(Targets.Num(), [&](int32 Index)
+	{
+		OutPlans[Index].AnimSequence = Targets[Index]->AnimSequence;
+		PlanTarget(Events, Table, Index, MappedTimes, EventOffsets, OutPlans[Index]);
+	});
+}
+
+void FReferenceGroupSync::PlanTarget(const TArray<FSyncSourceEvent>& Events, const FGaitIntervalTable& Table, int32 TargetIndex,
+	const TArray<float>& MappedTimes, const TArray<int32>& EventOffsets, FSyncTargetPlan& OutPlan)
+{
+	OutPlan.Markers.Reset();
+	OutPlan.Notifies.Reset();
+
+	for (int32 EventIndex = 0; EventIndex < Events.Num(); EventIndex++)
+	{
+		const FSyncSourceEvent & Event = Events[EventIndex];
+
+		// 当动画为多循环时，同一比例在目标上会有多个时间
+		const FGaitIntervalTable::FOrderTable & OrderTable = Table.GetTable(Event.bOrderIsLeftRight);
+		const float * SyncTime = MappedTimes.GetData() + EventOffsets[EventIndex] + OrderTable.GetTargetStart(TargetIndex);
+		const int32 NumSyncTime = OrderTable.GetTargetCount(TargetIndex);
+
+		TArray<FSyncPlannedEvent> & Planned = Event.bIsNotify ? OutPlan.Notifies : OutPlan.Markers;
+		for (int32 i = 0; i < NumSyncTime; i++)
+		{
+			const float Time = SyncTime[i];
+
+			// 避免向重复的时间添加标记
+			const bool ExistedAtTime = Planned.ContainsByPredicate([&](const FSyncPlannedEvent& Other)
+			{
+				return Other.TrackName == Event.TrackName && FMath::IsNearlyEqual(Other.Time, Time, DuplicateTolerance);
+			});
+			if (!ExistedAtTime)
+			{
+				FSyncPlannedEvent & NewEvent = Planned.AddDefaulted_GetRef();
+				NewEvent.TrackName = Event.TrackName;
+				NewEvent.Time = Time;
+				NewEvent.SourceIndex = EventIndex;
+			}
+		}
+	}
+}
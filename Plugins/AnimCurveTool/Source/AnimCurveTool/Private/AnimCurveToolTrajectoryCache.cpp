@@ -0,0 +1,228 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "AnimCurveToolTrajectoryCache.h"
+
+#include "AnimCurveToolContactDetector.h"
+#include "Animation/AnimSequence.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Trajectory Cache Hits"), STAT_TrajectoryCacheHits, STATGROUP_AnimCurveTool);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Trajectory Cache Misses"), STAT_TrajectoryCacheMisses, STATGROUP_AnimCurveTool);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Trajectory Cache Evictions"), STAT_TrajectoryCacheEvictions, STATGROUP_AnimCurveTool);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Trajectory Cache Entries"), STAT_TrajectoryCacheEntries, STATGROUP_AnimCurveTool);
+DECLARE_MEMORY_STAT(TEXT("Trajectory Cache Memory"), STAT_TrajectoryCacheMemory, STATGROUP_AnimCurveTool);
+
+void FQuantizedTrajectory::Quantize(const FFootTrajectory& Trajectory)
+{
+	const FCurveBakeResult & Samples = Trajectory.Samples;
+	const int32 NumCurves = Samples.CurveNames.Num();
+	BoneNames = Trajectory.BoneNames;
+	CurveNames = Samples.CurveNames;
+	NumFrames = Samples.NumFrames;
+	Mins.SetNumUninitialized(NumCurves);
+	Steps.SetNumUninitialized(NumCurves);
+	Values.SetNumUninitialized(NumCurves * NumFrames);
+	MaxError = 0.f;
+
+	for (int32 Curve = 0; Curve < NumCurves; Curve++)
+	{
+		const float * Source = Samples.GetCurveValues(Curve);
+		float Min = NumFrames > 0 ? Source[0] : 0.f;
+		float Max = Min;
+		for (int32 Frame = 1; Frame < NumFrames; Frame++)
+		{
+			Min = FMath::Min(Min, Source[Frame]);
+			Max = FMath::Max(Max, Source[Frame]);
+		}
+
+		// 范围为0的曲线步长为0，所有值还原为Min
+		const float Step = (Max - Min) / float(MAX_uint16);
+		const float InvStep = Step > 0.f ? 1.f / Step : 0.f;
+		Mins[Curve] = Min;
+		Steps[Curve] = Step;
+
+		uint16 * Out = Values.GetData() + Curve * NumFrames;
+		for (int32 Frame = 0; Frame < NumFrames; Frame++)
+		{
+			Out[Frame] = (uint16)FMath::Clamp(FMath::RoundToInt((Source[Frame] - Min) * InvStep), 0, (int32)MAX_uint16);
+			MaxError = FMath::Max(MaxError, FMath::Abs(Min + Out[Frame] * Step - Source[Frame]));
+		}
+	}
+}
+
+void FQuantizedTrajectory::Dequantize(UAnimSequence* AnimSequence, FFootTrajectory& OutTrajectory) const
+{
+	OutTrajectory.AnimSequence = AnimSequence;
+	OutTrajectory.BoneNames = BoneNames;
+
+	FCurveBakeResult & Samples = OutTrajectory.Samples;
+	Samples.AnimSequence = AnimSequence;
+	Samples.CurveNames = CurveNames;
+	Samples.NumFrames = NumFrames;
+	Samples.Times.SetNumUninitialized(NumFrames);
+	for (int32 Frame = 0; Frame < NumFrames; Frame++)
+	{
+		Samples.Times[Frame] = AnimSequence->GetTimeAtFrame(Frame);
+	}
+
+	Samples.Values.SetNumUninitialized(Values.Num());
+	for (int32 Curve = 0; Curve < CurveNames.Num(); Curve++)
+	{
+		const uint16 * Source = Values.GetData() + Curve * NumFrames;
+		float * Out = Samples.Values.GetData() + Curve * NumFrames;
+		for (int32 Frame = 0; Frame < NumFrames; Frame++)
+		{
+			Out[Frame] = Mins[Curve] + Source[Frame] * Steps[Curve];
+		}
+	}
+	Samples.bIsValid = true;
+}
+
+float FQuantizedTrajectory::GetErrorBound() const
+{
+	float MaxStep = 0.f;
+	for (float Step : Steps)
+	{
+		MaxStep = FMath::Max(MaxStep, Step);
+	}
+	return MaxStep * 0.5f;
+}
+
+SIZE_T FQuantizedTrajectory::GetAllocatedSize() const
+{
+	return sizeof(*this) + BoneNames.GetAllocatedSize() + CurveNames.GetAllocatedSize() + Mins.GetAllocatedSize() + Steps.GetAllocatedSize() + Values.GetAllocatedSize();
+}
+
+FTrajectoryCache& FTrajectoryCache::Get()
+{
+	static FTrajectoryCache Cache;
+	return Cache;
+}
+
+FString FTrajectoryCache::MakeKey(UAnimSequence* AnimSequence, const TArray<FName>& BoneNames)
+{
+	// 原始轨道数据改变时GUID随之改变，帧数与长度改变（例如调整播放速度）后同样不会命中旧的轨迹
+	FString Key = FString::Printf(TEXT("%s|%s|%d|%.6f"), *AnimSequence->GetPathName(), *AnimSequence->GetRawDataGuid().ToString(),
+		AnimSequence->GetNumberOfFrames(), AnimSequence->GetPlayLength());
+	for (FName BoneName : BoneNames)
+	{
+		Key += TEXT("|") + BoneName.ToString();
+	}
+	return Key;
+}
+
+bool FTrajectoryCache::Find(UAnimSequence* AnimSequence, const TArray<FName>& BoneNames, FFootTrajectory& OutTrajectory)
+{
+	const FString Key = MakeKey(AnimSequence, BoneNames);
+
+	FScopeLock ScopeLock(&Lock);
+	FEntry * Entry = Entries.Find(Key);
+	if (Entry == nullptr)
+	{
+		NumMisses++;
+		INC_DWORD_STAT(STAT_TrajectoryCacheMisses);
+		return false;
+	}
+
+	NumHits++;
+	INC_DWORD_STAT(STAT_TrajectoryCacheHits);
+	UsageList.RemoveNode(Entry->Node, false);
+	UsageList.AddHead(Entry->Node);
+	Entry->Trajectory.Dequantize(AnimSequence, OutTrajectory);
+	return true;
+}
+
+bool FTrajectoryCache::FindQuantized(UAnimSequence* AnimSequence, const TArray<FName>& BoneNames, FQuantizedTrajectory& OutTrajectory)
+{
+	const FString Key = MakeKey(AnimSequence, BoneNames);
+
+	FScopeLock ScopeLock(&Lock);
+	const FEntry * Entry = Entries.Find(Key);
+	if (Entry == nullptr)
+	{
+		return false;
+	}
+	OutTrajectory = Entry->Trajectory;
+	return true;
+}
+
+void FTrajectoryCache::Add(const FFootTrajectory& Trajectory)
+{
+	if (Trajectory.AnimSequence == nullptr || !Trajectory.Samples.bIsValid)
+	{
+		return;
+	}
+
+	// 量化在锁外进行
+	FEntry NewEntry;
+	NewEntry.Trajectory.Quantize(Trajectory);
+	NewEntry.Size = NewEntry.Trajectory.GetAllocatedSize();
+	const FString Key = MakeKey(Trajectory.AnimSequence, Trajectory.BoneNames);
+
+	FScopeLock ScopeLock(&Lock);
+	if (FEntry * Existing = Entries.Find(Key))
+	{
+		UsedBytes -= Existing->Size;
+		UsageList.RemoveNode(Existing->Node);
+		Entries.Remove(Key);
+		DEC_DWORD_STAT(STAT_TrajectoryCacheEntries);
+	}
+
+	// 单条轨迹超出全部预算时不缓存
+	if ((int64)NewEntry.Size > BudgetBytes)
+	{
+		return;
+	}
+
+	MaxErrorSeen = FMath::Max(MaxErrorSeen, NewEntry.Trajectory.MaxError);
+	MaxErrorBoundSeen = FMath::Max(MaxErrorBoundSeen, NewEntry.Trajectory.GetErrorBound());
+	UsageList.AddHead(Key);
+	NewEntry.Node = UsageList.GetHead();
+	UsedBytes += NewEntry.Size;
+	Entries.Add(Key, MoveTemp(NewEntry));
+	INC_DWORD_STAT(STAT_TrajectoryCacheEntries);
+
+	EvictToBudget();
+}
+
+void FTrajectoryCache::SetBudget(int64 InBudgetBytes)
+{
+	FScopeLock ScopeLock(&Lock);
+	BudgetBytes = FMath::Max<int64>(0, InBudgetBytes);
+	EvictToBudget();
+}
+
+void FTrajectoryCache::Empty()
+{
+	FScopeLock ScopeLock(&Lock);
+	Entries.Empty();
+	UsageList.Empty();
+	UsedBytes = 0;
+	SET_DWORD_STAT(STAT_TrajectoryCacheEntries, 0);
+	SET_MEMORY_STAT(STAT_TrajectoryCacheMemory, 0);
+}
+
+void FTrajectoryCache::EvictToBudget()
+{
+	// 从尾部（最久未使用）开始淘汰
+	while (UsedBytes > BudgetBytes && UsageList.GetTail() != nullptr)
+	{
+		TDoubleLinkedList<FString>::TDoubleLinkedListNode * Tail = UsageList.GetTail();
+		const FString Key = Tail->GetValue();
+		UsedBytes -= Entries.FindChecked(Key).Size;
+		Entries.Remove(Key);
+		UsageList.RemoveNode(Tail);
+		NumEvictions++;
+		INC_DWORD_STAT(STAT_TrajectoryCacheEvictions);
+		DEC_DWORD_STAT(STAT_TrajectoryCacheEntries);
+	}
+	SET_MEMORY_STAT(STAT_TrajectoryCacheMemory, UsedBytes);
+}
+
+void FTrajectoryCache::LogStats()
+{
+	FScopeLock ScopeLock(&Lock);
+	const int64 NumLookups = NumHits + NumMisses;
+	UE_LOG(LogTemp, Log, TEXT("Trajectory cache: %d entries, %.2f / %.2f MB, %lld hits, %lld misses (%.1f%% hit rate), %lld evictions, max dequantization error %.5f cm (bound %.5f cm)."),
+		Entries.Num(), UsedBytes / (1024.0 * 1024.0), BudgetBytes / (1024.0 * 1024.0), NumHits, NumMisses,
+		NumLookups > 0 ? 100.0 * NumHits / NumLookups : 0.0, NumEvictions, MaxErrorSeen, MaxErrorBoundSeen);
+}
@@ -0,0 +1,209 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "SAnimGroupListView.h"
+
+#include "AnimCurveTool.h"
+#include "Widgets/Layout/SBox.h"
+#include "Widgets/Text/STextBlock.h"
+#include "Widgets/Views/SHeaderRow.h"
+
+#define LOCTEXT_NAMESPACE "FAnimCurveToolModule"
+
+static const FName AnimGroupColumnName("Name");
+static const FName AnimGroupColumnDirection("Direction");
+static const FName AnimGroupColumnMarkers("Markers");
+static const FName AnimGroupColumnAnalysed("Analysed");
+
+// 多列的行控件，文字通过Lambda绑定到行数据，状态更新时不需要重建控件
+class SAnimGroupListRow : public SMultiColumnTableRow<FAnimGroupListItemPtr>
+{
+public:
+	SLATE_BEGIN_ARGS(SAnimGroupListRow) {}
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs, const TSharedRef<STableViewBase>& OwnerTable, FAnimGroupListItemPtr InItem)
+	{
+		Item = InItem;
+		SMultiColumnTableRow<FAnimGroupListItemPtr>::Construct(FSuperRowType::FArguments(), OwnerTable);
+	}
+
+	virtual TSharedRef<SWidget> GenerateWidgetForColumn(const FName& ColumnName) override
+	{
+		FAnimGroupListItemPtr RowItem = Item;
+		TAttribute<FText> Text;
+		if (ColumnName == AnimGroupColumnName)
+		{
+			Text = TAttribute<FText>::Create([RowItem]() { return RowItem->Name; });
+		}
+		else if (ColumnName == AnimGroupColumnDirection)
+		{
+			Text = TAttribute<FText>::Create([RowItem]() { return RowItem->Direction; });
+		}
+		else if (ColumnName == AnimGroupColumnMarkers)
+		{
+			Text = TAttribute<FText>::Create([RowItem]() { return RowItem->MarkerCount; });
+		}
+		else
+		{
+			Text = TAttribute<FText>::Create([RowItem]() { return RowItem->AnalysisTime; });
+		}
+
+		return SNew(SBox)
+			.Padding(FMargin(4, 1))
+			[
+				SNew(STextBlock)
+				.Text(Text)
+			];
+	}
+
+private:
+	FAnimGroupListItemPtr Item;
+};
+
+void SAnimGroupListView::Construct(const FArguments& InArgs)
+{
+	OnGetReference = InArgs._OnGetReference;
+
+	ChildSlot
+	[
+		SNew(SBox)
+		.HeightOverride(InArgs._Height)
+		.MinDesiredWidth(360.0f)
+		[
+			SAssignNew(ListView, SListView<FAnimGroupListItemPtr>)
+			.ListItemsSource(&Items)
+			.SelectionMode(ESelectionMode::None)
+			.OnGenerateRow(this, &SAnimGroupListView::OnGenerateRow)
+			.HeaderRow
+			(
+				SNew(SHeaderRow)
+				+ SHeaderRow::Column(AnimGroupColumnName)
+				.DefaultLabel(this, &SAnimGroupListView::GetNameColumnLabel)
+				.FillWidth(0.5f)
+				+ SHeaderRow::Column(AnimGroupColumnDirection)
+				.DefaultLabel(LOCTEXT("AnimGroupDirection", "Dir"))
+				.FillWidth(0.12f)
+				+ SHeaderRow::Column(AnimGroupColumnMarkers)
+				.DefaultLabel(LOCTEXT("AnimGroupMarkers", "Markers"))
+				.FillWidth(0.15f)
+				+ SHeaderRow::Column(AnimGroupColumnAnalysed)
+				.DefaultLabel(LOCTEXT("AnimGroupAnalysed", "Analysed"))
+				.FillWidth(0.23f)
+			)
+		]
+	];
+}
+
+void SAnimGroupListView::AddItems(const TArray<UAnimSequence*>& AnimSequences)
+{
+	bool bChanged = false;
+	for (UAnimSequence * Anim : AnimSequences)
+	{
+		if (Anim && !ItemMap.Contains(Anim))
+		{
+			Items.Add(MakeItem(Anim));
+			bChanged = true;
+		}
+	}
+
+	if (bChanged)
+	{
+		ListView->RequestListRefresh();
+	}
+}
+
+void SAnimGroupListView::SetItems(const TArray<UAnimSequence*>& AnimSequences)
+{
+	// 保留仍然存在的行数据，使列表只为新增的可见行生成控件
+	TMap<UAnimSequence*, FAnimGroupListItemPtr> OldItemMap = MoveTemp(ItemMap);
+	ItemMap.Reset();
+	Items.Reset(AnimSequences.Num());
+
+	for (UAnimSequence * Anim : AnimSequences)
+	{
+		if (!Anim || ItemMap.Contains(Anim))
+		{
+			continue;
+		}
+
+		FAnimGroupListItemPtr Existing;
+		if (OldItemMap.RemoveAndCopyValue(Anim, Existing))
+		{
+			Items.Add(Existing);
+			ItemMap.Add(Anim, Existing);
+		}
+		else
+		{
+			Items.Add(MakeItem(Anim));
+		}
+	}
+
+	ListView->RequestListRefresh();
+}
+
+void SAnimGroupListView::ResetItems()
+{
+	Items.Reset();
+	ItemMap.Reset();
+	ListView->RequestListRefresh();
+}
+
+void SAnimGroupListView::RefreshStatus(UAnimSequence* AnimSequence)
+{
+	if (FAnimGroupListItemPtr* Item = ItemMap.Find(AnimSequence))
+	{
+		UpdateItemStatus(**Item);
+	}
+}
+
+void SAnimGroupListView::RefreshAllStatus()
+{
+	for (FAnimGroupListItemPtr & Item : Items)
+	{
+		UpdateItemStatus(*Item);
+	}
+}
+
+FAnimGroupListItemPtr SAnimGroupListView::MakeItem(UAnimSequence* AnimSequence)
+{
+	FAnimGroupListItemPtr Item = MakeShared<FAnimGroupListItem>();
+	Item->AnimSequence = AnimSequence;
+	Item->Name = FText::FromString(AnimSequence->GetName());
+	UpdateItemStatus(*Item);
+	ItemMap.Add(AnimSequence, Item);
+	return Item;
+}
+
+void SAnimGroupListView::UpdateItemStatus(FAnimGroupListItem& Item) const
+{
+	const SGMarkerReference * Reference = OnGetReference.IsBound() ? OnGetReference.Execute(Item.AnimSequence) : nullptr;
+	if (Reference)
+	{
+		Item.Direction = FText::FromString(SGMarkerReference::GetDirectionName(Reference->Dir));
+		Item.MarkerCount = FText::AsNumber(Reference->LeftMarkers.Num() + Reference->RightMarkers.Num());
+		// 使用了后备检测器的动画在时间后标出检测器名称
+		const FString Time = Reference->AnalysisTime.ToString(TEXT("%H:%M:%S"));
+		Item.AnalysisTime = FText::FromString(Reference->bUsedFallback ? Time + " (" + Reference->DetectorName.ToString() + ")" : Time);
+	}
+	else
+	{
+		// 未经预计算的动画只显示根据命名得到的方向
+		Direction Dir;
+		const bool bNamed = SGMarkerReference::GetDirectionFromName(Item.Name.ToString(), Dir);
+		Item.Direction = FText::FromString(bNamed ? SGMarkerReference::GetDirectionName(Dir) : FString("?"));
+		Item.MarkerCount = FText::FromString("-");
+		Item.AnalysisTime = FText::FromString("-");
+	}
+}
+
+TSharedRef<ITableRow> SAnimGroupListView::OnGenerateRow(FAnimGroupListItemPtr Item, const TSharedRef<STableViewBase>& OwnerTable)
+{
+	return SNew(SAnimGroupListRow, OwnerTable, Item);
+}
+
+FText SAnimGroupListView::GetNameColumnLabel() const
+{
+	return FText::Format(LOCTEXT("AnimGroupName", "Name ({0})"), FText::AsNumber(Items.Num()));
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -7,6 +7,11 @@
 #include <ios>
 
 #include "Modules/ModuleManager.h"
+#include "Containers/Queue.h"
+#include "Containers/Ticker.h"
+#include "Async/Future.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "UObject/StrongObjectPtr.h"
 #include "Animation/AnimSequence.h"
 #include "AssetThumbnail.h"
 #include "PropertyCustomizationHelpers.h"
@@ -20,9 +25,17 @@
 #include "UObject/UObjectGlobals.h"
 #include "AnimationUtils.h"
 #include "IContentBrowserSingleton.h"
+#include "SAnimGroupListView.h"
+#include "AnimCurveToolSelection.h"
+#include "AnimCurveToolCurveBaker.h"
+#include "AnimCurveToolGaitCache.h"
+#include "AnimCurveToolSync.h"
 
 class FToolBarBuilder;
 class FMenuBuilder;
+struct FFootTrajectory;
+struct FContactDetectorSettings;
+class IContactDetector;
 
 // 动画运动方向的标签枚举
 enum Direction {l, r, f, b, lf, rf, lb, rb};
@@ -50,45 +63,62 @@ class SGMarkerReference
 {
 public:
 	
-	// 同步组的构造函数，在其中进行步态位置的预计算
+	// 同步组的构造函数，在其中进行步态位置的预计算，使用默认的转折点检测器
 	SGMarkerReference(UAnimSequence* AnimSequence, FName LeftFoot, FName RightFoot);
 
+	// 在已采样的脚部轨迹上使用指定的检测器计算基准点，不再重新采样
+	SGMarkerReference(UAnimSequence* AnimSequence, FName LeftFoot, FName RightFoot, const FFootTrajectory& Trajectory, const IContactDetector& Detector, const FContactDetectorSettings& Settings);
+
+	// 从步态缓存的视图恢复，不重新计算
+	SGMarkerReference(UAnimSequence* AnimSequence, const FGaitCacheEntryView& CacheView);
+
+	// 由镜像动画的结果推出：左右脚的基准点与离地点互换，时间不变
+	SGMarkerReference(UAnimSequence* AnimSequence, const SGMarkerReference& MirrorSource);
+
 	// 根据动画命名判断动画的移动方向
 	Direction GetAnimDirection();
+	static bool GetDirectionFromName(const FString& AnimName, Direction& OutDir);
+
+	// 左右镜像动画的名称：FL/FR，BL/BR，L/R互换，前后方向的动画没有镜像
+	static bool GetMirrorName(const FString& AnimName, FString& OutMirrorName);
+
+	// 方向标签的显示名称
+	static FString GetDirectionName(Direction Dir);
 
 	// 根据输入时间，找到其所在的区间，并计算在区间中的比例以及区间为左-右脚，还是右-左脚
-	bool GetRatioFromTime(float Time, float & RefRatio, bool & IsOrderLeftRight);
+	bool GetRatioFromTime(float Time, float & RefRatio, bool & IsOrderLeftRight) const;
 
 	// 根据输入的比例，计算在每一个区间中该比例的对应时间并返回，左-右顺序用于筛选区间
-	bool GetTimeFromRatio(float RefRatio, bool IsOrderLeftRight, TArray<float> & Time);
+	bool GetTimeFromRatio(float RefRatio, bool IsOrderLeftRight, TArray<float> & Time) const;
 
-	// 计算腿部骨骼改变运动方向的而函数
-	TArray<float> GetContactTimeFromTurning(UAnimSequence * AnimSequence, FName BoneName);
+	// 用检测器在轨迹上计算左右脚的基准点与离地点，并据此生成基准区间
+	void Initialize(FName LeftFoot, FName RightFoot, const FFootTrajectory& Trajectory, const IContactDetector& Detector, const FContactDetectorSettings& Settings);
 
-	// 根据动画方向标签，判断本帧是否为改变方向的点
-	bool IsTurningPoint(FTransform LastFrame, FTransform CurFrame, FTransform NextFrame);
-	
-	// 根据z轴高度计算基准点的方案的相关函数，目前不再使用
-	//TArray<float> GetContactTime(UAnimSequence * AnimSequence, FName BoneName, float Threshold);
-	// 根据动画方向标签，判断目标帧对比上一帧在移动方向上的位移
-	//float GetDisplacementAtFrame(int i, FName BoneName);
-	// 根据动画方向标签，判断累积位移的方向是否正确
-	//bool IsCumulativeDistanceValid(float Distance);
-	// 计算高度阈值的函数
-	//float CalculateThreshold(FName BoneName);
-
-	// 计算腿部与根骨骼交叉的时间的函数，目前已不再使用
-	//TArray<float> GetCrossingTime(UAnimSequence * AnimSequence, FName FNameBone);
-	// 根据当前帧与上一帧的变换，判断当前帧是否为脚部骨骼越过根骨骼的时刻
-	//bool IsCrossingPoint(FTransform Transform, FTransform OldTransform, Direction Dir);
+	// 由排序后的左右脚基准点生成基准区间
+	void BuildIntervals();
 	
 	UAnimSequence * AnimSequence;
 	float Tolerance;
 	Direction Dir;
 	bool bIsValid;
+	// 计算基准点所用的检测器，所选检测器超出限制时为后备检测器
+	FName DetectorName;
+	bool bUsedFallback = false;
+	// 因超出时间预算而使用后备检测器，结果取决于当时的机器负载，不写入步态缓存
+	bool bFallbackFromDeadline = false;
+	// 完成预计算的时间，用于在分组预览中显示
+	FDateTime AnalysisTime;
+	// 写入步态缓存时使用的数据哈希与设置哈希，为0时不写入缓存
+	uint64 CacheDataHash = 0;
+	uint64 CacheSettingsHash = 0;
+	// 由镜像动画的结果推出，没有单独计算
+	bool bFromMirror = false;
 	// Sorted Array for Markers
 	TArray<float> LeftMarkers;
 	TArray<float> RightMarkers;
+	// Sorted Array for Lift-offs
+	TArray<float> LeftLiftOffs;
+	TArray<float> RightLiftOffs;
 	TArray<FootInterval> Intervals;
 	//float LeftThreshold, RightThreshold;
 };
@@ -116,29 +146,37 @@ private:
 	TSharedRef<SWidget> MakeAnimPicker();
 
 	
-	TArray<UAnimSequence*> SelectedAnimGroup;
+	FAnimSelection SelectedAnimGroup;
 	TSharedPtr<SWidget> AnimContentPicker;
-	TSharedPtr<STextBlock> SelectedAnimGroupPreview;
+	TSharedPtr<SAnimGroupListView> SelectedAnimGroupPreview;
 	
 
-/*  用于提取动画曲线的工具不再使用了   */
-/*
+/*  曲线烘焙工具，替代原先逐条曲线保存资源的曲线提取工具   */
 protected:
-	//Entry function for creating extractor widget
-	TSharedRef<SWidget> MakeCurveExtractor();
-	
-	TSharedRef<SWidget> OnGetAnimMenu();
-	void OnAnimAssetSelected(const FAssetData& AssetData);
+	/* 构建用于曲线烘焙的UI控件 */
+	TSharedRef<SWidget> MakeCurveBaker();
+
+	/* 对动画选择模块中的所有动画批量烘焙曲线，为按钮的回调 */
+	FReply BakeCurvesOnClicked();
 
-	FReply ExtractBoneCurve();
+	/* 根据UI状态生成烘焙设置 */
+	FCurveBakeSettings MakeCurveBakeSettings() const;
 
-	// Functions that work with the editable text created for curve extractor
-	FText GetBoneName() const;
-	void OnBoneNameCommitted(const FText& InText, ETextCommit::Type CommitInfo);
+	/* 将一组动画的曲线写入动画序列，或每个动画写入一个曲线表资源并统一保存 */
+	void WriteBakedCurves(const TArray<FBakedAnimCurves>& BakedAnims, bool bToCurveAsset);
+
+	/* 关键帧精简的误差，所有烘焙的曲线共用 */
+	float GetKeyToleranceValue() const;
+
+	// Functions that work with the editable text created for curve baker
+	FText GetBakeBoneNames() const;
+	void OnBakeBoneNamesCommitted(const FText& InText, ETextCommit::Type CommitInfo);
 	FText GetTransScale() const;
 	void OnTransScaleCommitted(const FText& InText, ETextCommit::Type CommitInfo);
 	FText GetRotScale() const;
 	void OnRotScaleCommitted(const FText& InText, ETextCommit::Type CommitInfo);
+	FText GetKeyTolerance() const;
+	void OnKeyToleranceCommitted(const FText& InText, ETextCommit::Type CommitInfo);
 
 	// Functions that help with creating output selection checkboxes
 	ECheckBoxState IsOutputBoxChecked(FString Type, FString Axis) const;
@@ -147,30 +185,16 @@ protected:
 	TSharedRef<SWidget> MakeOutputCheckboxRow(FString Type);
 	void OnSavePathSelected(const FString& NewPath);
 
-	// Functions that process and save the extracted curves
-	bool FillCurveVector();
-	void SaveCurve();
-	void SaveCurveFloat(FString Type, FString Axis) const;
-
 private:
-	UAnimSequence * AnimSequenceToExtract = nullptr;
-	TArray<FVector> TransCurve;
-	TArray<FVector> RotCurve;
-	TArray<FVector> ScaleCurve;
+	FText BakeBoneNames;
 	FText TransScale;
 	FText RotScale;
+	FText KeyTolerance;
 	FString SavePath;
+	bool bBakeRootRelative;
+	bool bBakeToCurveAsset;
 
-	// cache for created widget
-	TSharedPtr<SWidget> SelectAnimSequenceWidgetPtr;
-	TSharedPtr<SComboButton> SelectAnimSequenceButtonPtr;
-	TSharedPtr<FAssetThumbnail> AnimThumbnailPtr;
-	TSharedPtr<FAssetThumbnailPool> AnimThumbnailPoolPtr;
-	TSharedPtr<SWidget> AnimSequencePicker;
-
-	FName TargetBoneName;
-
-	TMap<FString, bool> OutputBoxStateMap;*/
+	TMap<FString, bool> OutputBoxStateMap;
 
 
 protected:
@@ -184,18 +208,24 @@ protected:
 	/* 读取动画选择模块中的SelectedAnimGroup，更新AnimGroupToScale */
 	void UpdateAnimGroupToScale();
 	
-	/*  判断动画是否通过筛选的函数，目前的筛选规则为前后缀*/
+	/*  判断动画是否通过筛选的函数，筛选规则为前后缀与编译后的名称规则*/
 	bool CheckShouldSelectAnim(FAssetData Asset) const;
 	bool CheckShouldSelectAnim(UAnimSequence* AnimSequence) const;
 
-	/* 根据输入动画序列，更新文字控件内容的方法 */
-	void UpdatePreviewText(TArray<UAnimSequence *> &, TSharedRef<STextBlock>);
+	/* 构建分组预览列表，各列表共用同步组的查询回调 */
+	TSharedRef<SAnimGroupListView> MakeAnimGroupList(TSharedPtr<SAnimGroupListView>& OutList);
+	const SGMarkerReference* FindAnimReference(UAnimSequence* AnimSequence) const;
 
 	/* 不同Editable Text控件的显示与修改时的回调 */
 	FText GetAnimPrefix() const;
 	void OnAnimPrefixCommitted(const FText& InText, ETextCommit::Type CommitInfo);
 	FText GetAnimPostfix() const;
 	void OnAnimPostfixCommitted(const FText& InText, ETextCommit::Type CommitInfo);
+	FText GetAnimNameRules() const;
+	void OnAnimNameRulesCommitted(const FText& InText, ETextCommit::Type CommitInfo);
+
+	/* 筛选文本提交时重新编译筛选器 */
+	void CompileAnimFilter();
 	FText GetRateScale() const;
 	void OnRateScaleCommitted(const FText& InText, ETextCommit::Type CommitInfo);
 	FText GetRootMotionSpeed() const;
@@ -205,14 +235,19 @@ protected:
 	FReply ApplyRateScale() const;
 	/* 按目标RootMotionSpeed修改动画播放速率，为按钮的回调*/
 	FReply ApplyRootMotionSpeed() const;
+
+	/* 为所有待缩放的动画烘焙根骨骼的距离匹配曲线，为按钮的回调 */
+	FReply BakeDistanceCurvesOnClicked();
 	
 
 private:
 	FString AnimToScalePath;
 	TArray<UAnimSequence *> AnimSequencesToScale; 
-	TSharedPtr<STextBlock> AnimSequencesToScalePreview;
+	TSharedPtr<SAnimGroupListView> AnimSequencesToScalePreview;
 	FText AnimPrefix;
 	FText AnimPostfix;
+	FText AnimNameRules;
+	FAnimNameFilter AnimFilter;
 	FText RateScale;
 	FText RootMotionSpeed;
 
@@ -239,7 +274,34 @@ protected:
 
 	/* 将动画序列进行预计算并加入同步组TMap中保存 */
 	FReply AddAllReferenceGroup();
-	void AddToReferenceGroup(TArray<UAnimSequence*> &, TMap<UAnimSequence*, SGMarkerReference>&);
+	void AddToReferenceGroup(const TArray<UAnimSequence*> &, TMap<UAnimSequence*, SGMarkerReference>&);
+
+	/* 游戏线程的Ticker：在时间片内取出后台分析完成的结果写入基准组并刷新列表，全部完成后输出报告 */
+	bool DrainReferenceResults(float DeltaTime);
+
+	/* 取消正在进行的后台分析：工作线程跳过剩余任务，已完成的结果不再写入基准组 */
+	void CancelReferenceAnalysis();
+
+	/* 将当前的任务与其动画引用移入已取消的批次，并释放已经结束的批次 */
+	void RetireReferenceBatch();
+	void ReleaseRetiredReferenceBatches();
+
+	/* 没有正在进行的后台分析时，使用基准组的按钮才可用 */
+	bool IsReferenceGroupReady() const;
+
+	/* 落地检测器的选择，以及检测器共用的参数 */
+	TSharedRef<SWidget> MakeContactDetectorPicker();
+	FContactDetectorSettings MakeContactDetectorSettings() const;
+	FText GetAnalysisStride() const;
+	void OnAnalysisStrideCommitted(const FText& InText, ETextCommit::Type CommitInfo);
+	FText GetTrajectoryCacheBudget() const;
+	void OnTrajectoryCacheBudgetCommitted(const FText& InText, ETextCommit::Type CommitInfo);
+
+	/* 由粗到细的结果与全帧率结果的最大时间误差，基准点数量不同时返回false */
+	static bool GetMaxMarkerError(const SGMarkerReference& Coarse, const SGMarkerReference& Full, float& OutError);
+
+	/* 对选中的动画只采样一次轨迹，运行所有检测器并输出结果以便比较，为按钮的回调 */
+	FReply CompareDetectorsOnClicked();
 
 	/* 清空当前同步组的方法，为按钮的回调 */
 	FReply ClearReferenceGroup();
@@ -254,28 +316,49 @@ protected:
 	FReply SyncReferenceGroupOnClicked();
 	void SyncReferenceGroup(UAnimSequence * RefAnimSequence, FName TrackName);
 
+	/* 同步任务：将多个(参考动画, 轨道)一起换算，每个目标动画只修改一次 */
+	FReply AddToSyncJobOnClicked();
+	FReply ClearSyncJobOnClicked();
+	FReply RunSyncJobOnClicked();
+	void RunSyncJob(const TArray<FSyncJobSource>& Sources);
+	void UpdateSyncJobPreview();
+
+	/* 在游戏线程上一次性应用某个目标的同步结果，清空并重建指定的轨道 */
+	void ApplySyncPlan(const FSyncTargetPlan& Plan, const TArray<FSyncSourceEvent>& Events, const TArray<FName>& TrackNames);
+
+	/* 由同步组的步态分析结果为每个动画烘焙接触曲线与锁脚曲线，为按钮的回调 */
+	FReply BakeFootCurvesOnClicked();
+	FText GetContactBlendTime() const { return ContactBlendTime; }
+	void OnContactBlendTimeCommitted(const FText& InText, ETextCommit::Type CommitInfo) { ContactBlendTime = InText; }
+	FText GetLockBlendTime() const { return LockBlendTime; }
+	void OnLockBlendTimeCommitted(const FText& InText, ETextCommit::Type CommitInfo) { LockBlendTime = InText; }
+
+	/* 由同步组的基准区间为每个动画烘焙步态相位曲线，为按钮的回调 */
+	FReply BakePhaseCurvesOnClicked();
+
+	/* 将同步组的步态分析结果烘焙为动画上的运行时步态表（UGaitTableUserData），为按钮的回调 */
+	FReply BakeGaitTablesOnClicked();
 	/* 添加默认的同步组标签，时间值由底层算法决定，目前为双腿分别经过root的时刻 */
 	FReply AddDefaultMarkerForReferenceGroup();
 
 	/* 用于添加同步组标记的helper function */
 	void AddContactMarker(UAnimSequence * AnimSequence, FName TrackName, FName MarkerName, float MarkerTime);
-	void AddAnimationSyncMarker(UAnimSequence* AnimationSequence, FName MarkerName, float Time, FName TrackName);
+	void AddAnimationSyncMarker(UAnimSequence* AnimationSequence, FName MarkerName, float Time, FName TrackName, bool bRefreshCache = true);
 
-	/* 用于添加动画通知的helper function */
-	UAnimNotify* AddAnimationNotifyEvent(UAnimSequence* AnimationSequence, FName NotifyTrackName, float StartTime, TSubclassOf<UAnimNotify> NotifyClass);
+	/* 用于添加动画通知的helper function，批量添加时可以关闭缓存刷新，由调用方最后统一刷新 */
+	UAnimNotify* AddAnimationNotifyEvent(UAnimSequence* AnimationSequence, FName NotifyTrackName, float StartTime, TSubclassOf<UAnimNotify> NotifyClass, bool bRefreshCache = true);
 
 	/* 用于处理动画轨道的helper function */
 	void AddAnimationNotifyTrack(UAnimSequence* AnimationSequence, FName NotifyTrackName, FLinearColor TrackColor);
 	void RemoveAnimationNotifyTrack(UAnimSequence* AnimationSequence, FName NotifyTrackName);
-	int32 GetTrackIndexForAnimationNotifyTrackName(const UAnimSequence* AnimationSequence, FName NotifyTrackName);
 
 public:
 
 	/* 用于计算骨骼相对于根的相对变换 */
 	static FTransform GetBoneTMRelativeToRoot(UAnimSequence* AnimationSequence, FName BoneName, int Frame);
 
-	/* 计算并返回选定骨骼到根骨骼的路径 */
-	static void FindBonePathToRoot(const UAnimSequence* AnimationSequence, FName BoneName, TArray<FName>& BonePath);
+	/* 获取通知轨道索引的helper function */
+	static int32 GetTrackIndexForAnimationNotifyTrackName(const UAnimSequence* AnimationSequence, FName NotifyTrackName);
 
 	/* 获取轨道索引的helper function */
 	static int32 GetAnimTrackIndexForSkeletonBone(const int32 InSkeletonBoneIndex, const TArray<FTrackToSkeletonMap>& TrackToSkelMap);
@@ -291,13 +374,63 @@ private:
 	TArray<UAnimSequence *> AutoMarkAnimGroup;
 	//TArray<SGMarkerReference> AnimReferenceGroup;
 	TMap<UAnimSequence*, SGMarkerReference> AnimReferenceGroup;
+
+	// 后台分析完成的单个动画，采样失败时Reference为空
+	struct FReferenceAnalysisResult
+	{
+		UAnimSequence * AnimSequence = nullptr;
+		TUniquePtr<SGMarkerReference> Reference;
+		// 产生结果的批次，与当前批次不同时丢弃
+		int32 BatchId = 0;
+		// 由步态缓存恢复，不需要写回缓存
+		bool bFromCache = false;
+		// 本批中内容与该动画相同的动画，结果写入时一并复制
+		TArray<UAnimSequence*> Duplicates;
+	};
+	// 工作线程放入，游戏线程取出的无锁队列
+	TQueue<FReferenceAnalysisResult, EQueueMode::Mpsc> ReferenceResults;
+	TFuture<void> ReferenceAnalysisTask;
+	// 当前批次的编号，工作线程也会读取；取消时递增
+	FThreadSafeCounter ReferenceBatchId;
+	// 后台任务访问的动画在任务结束前不会被回收
+	TArray<TStrongObjectPtr<UAnimSequence>> ReferenceBatchAnims;
+	// 已取消但仍在运行的批次，任务结束前保留其动画的引用，游戏线程不需要等待
+	struct FRetiredReferenceBatch
+	{
+		TFuture<void> Task;
+		TArray<TStrongObjectPtr<UAnimSequence>> Anims;
+	};
+	TArray<FRetiredReferenceBatch> RetiredReferenceBatches;
+	FDelegateHandle ReferenceDrainHandle;
+	TMap<UAnimSequence*, SGMarkerReference> * ReferenceDrainGroup = nullptr;
+	int32 NumMirroredReferences = 0;
+	int32 NumCachedReferences = 0;
+	// 持久化的步态分析结果，加入基准组时先查找
+	FGaitCache GaitCache;
+	// 以下只在游戏线程上访问：尚未取出的结果数量，以及本批的报告
+	int32 NumPendingReferences = 0;
+	TArray<UAnimSequence*> ReferenceAddedAnims;
+	TArray<FString> ReferenceFallbackAnims;
+	TArray<FString> ReferenceFailedAnims;
+	// 每帧写入结果的时间片（秒）
+	static constexpr double ReferenceDrainTimeSlice = 0.004;
 	TSharedPtr<SComboButton> SelectRefAnimButtonPtr;
 	TSharedPtr<SWidget> SelectRefAnimWidgetPtr;
 	TSharedPtr<FAssetThumbnail> RefAnimThumbnailPtr;
 	TSharedPtr<FAssetThumbnailPool> RefAnimThumbnailPoolPtr;
 	TSharedPtr<STextBlock> AnimSequencesToMarkPreview;
-	TSharedPtr<STextBlock> AnimReferenceGroupPreview;
+	TSharedPtr<SAnimGroupListView> AnimReferenceGroupPreview;
 	FName RefTrackName;
+	TArray<FSyncJobSource> SyncJobSources;
+	TSharedPtr<STextBlock> SyncJobPreview;
+	FName ContactDetectorName;
+	bool bSubFrameRefine;
+	FText AnalysisStride;
+	bool bVerifyAnalysis;
+	FText TrajectoryCacheBudget;
+	FText ContactBlendTime;
+	FText LockBlendTime;
+	bool bPhaseHalfCycle;
 
 
 private:
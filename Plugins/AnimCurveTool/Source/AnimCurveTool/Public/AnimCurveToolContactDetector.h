@@ -0,0 +1,178 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AnimCurveTool.h"
+#include "AnimCurveToolCurveBaker.h"
+
+class IContactDetector;
+struct FContactDetectorSettings;
+
+// 一个动画中若干脚部骨骼相对根骨骼的预采样轨迹，每只脚的X/Y/Z各为一段连续数组，所有检测器共用
+struct FFootTrajectory
+{
+	UAnimSequence * AnimSequence = nullptr;
+	TArray<FName> BoneNames;
+	// 每只脚依次为X，Y，Z三条曲线
+	FCurveBakeResult Samples;
+
+	/* 一次遍历所有帧，同时采样所有脚部骨骼，任意骨骼找不到时采样失败，长动画按ChunkFrames分块并行 */
+	bool Sample(UAnimSequence* InAnimSequence, const TArray<FName>& InBoneNames, int32 ChunkFrames = 0);
+
+	/* 由粗到细的采样：先每AnalysisStride帧采样一次并在其上运行检测器，
+	   只在检测到的事件附近采样全部帧，其余帧由相邻采样线性插值，步长不大于1时等同于Sample */
+	bool SampleCoarseToFine(UAnimSequence* InAnimSequence, const TArray<FName>& InBoneNames, const IContactDetector& Detector, const FContactDetectorSettings& Settings);
+
+	/* 两个动画是否互为镜像：在均匀分布的探测帧上，A的第k只脚与B的第k只脚（MirrorBoneNames中左右互换）
+	   X取反后的位置误差都在Tolerance之内；轨迹缓存中有时直接使用，否则只采样探测帧 */
+	static bool IsMirrorPair(UAnimSequence* A, const TArray<FName>& InBoneNames, UAnimSequence* B, const TArray<FName>& MirrorBoneNames, int32 NumProbes, float Tolerance);
+
+	/* 脚部骨骼相对根骨骼位移的采样设置 */
+	static FCurveBakeSettings MakeBakeSettings(const TArray<FName>& InBoneNames, int32 ChunkFrames = 0);
+
+	int32 GetNumFrames() const { return Samples.NumFrames; }
+	int32 GetFootIndex(FName BoneName) const { return BoneNames.IndexOfByKey(BoneName); }
+	float GetTime(int32 Frame) const { return Samples.Times[Frame]; }
+	const float* GetAxis(int32 Foot, int32 Axis) const { return Samples.GetCurveValues(Foot * 3 + Axis); }
+	FVector GetLocation(int32 Foot, int32 Frame) const;
+};
+
+// 检测器共用的参数
+struct FContactDetectorSettings
+{
+	Direction Dir = Direction::f;
+	// 高度检测：最低点之上的容差
+	float HeightTolerance = 0.5f;
+	// 转折点检测：转折点之后脚部每帧下降幅度小于该值时视为落地
+	float TurningDescentThreshold = 0.25f;
+
+	// 速度检测：与站立参考速度的偏差低于PlantSpeed且高度低于PlantHeightRatio时进入站立，
+	// 偏差高于ReleaseSpeed或高度高于ReleaseHeightRatio时离开站立（cm/s，高度为相对高度范围的比例）
+	float PlantSpeedThreshold = 20.f;
+	float ReleaseSpeedThreshold = 40.f;
+	float PlantHeightRatio = 0.2f;
+	float ReleaseHeightRatio = 0.35f;
+
+	// 粗采样的帧间隔，为1时采样所有帧
+	int32 AnalysisStride = 1;
+	// 粗采样检测到的事件前后各采样多少个粗采样间隔的全部帧
+	int32 RefineWindowStrides = 2;
+	// 长动画的采样与转折点检测按该帧数分块并行，为0时不分块
+	int32 ChunkFrames = 2048;
+
+	// 镜像动画的判断：探测帧数量与位置误差（cm），判断成立时直接由另一个动画的结果推出
+	int32 MirrorProbeFrames = 8;
+	float MirrorTolerance = 1.f;
+
+	// 与全帧率结果比较时允许的最大时间误差（秒）
+	float VerifyTolerance = 0.02f;
+
+	// 用相邻帧拟合二次多项式，将落地与离地时间精化到帧之间
+	bool bSubFrameRefine = true;
+
+	// 转折点之后寻找稳定低点的最大帧数
+	int32 MaxSearchFrames = 30;
+	// 每个动画的检测时间预算（秒），超出或搜索失败时改用后备检测器
+	float TimeBudget = 2.f;
+	FName FallbackDetectorName = FName("Velocity");
+	// 由调用方根据TimeBudget设置的截止时间，为0时不限制
+	double Deadline = 0.0;
+
+	bool IsOverBudget() const { return Deadline > 0.0 && FPlatformTime::Seconds() > Deadline; }
+};
+
+// 一只脚的检测结果，时间均已排序
+struct FContactDetection
+{
+	TArray<float> Contacts;
+	TArray<float> LiftOffs;
+	// 落地搜索起点的转折点时间，只有转折点检测器输出，由粗到细采样时在其附近同样采样全部帧
+	TArray<float> TurningPoints;
+	// 搜索超出帧数限制或时间预算，结果不可用
+	bool bAborted = false;
+};
+
+// 亚帧精化：以检测到的帧为0，用-1，0，1三帧拟合 y = a*x^2 + b*x + c，每个事件的开销为常数
+class FSubFrameRefiner
+{
+public:
+	/* 极值点相对当前帧的偏移，限制在[-0.5, 0.5]帧之内 */
+	static float GetExtremumOffset(float Prev, float Cur, float Next);
+
+	/* 信号在上一帧与当前帧之间穿过Threshold的位置，范围[-1, 0]，二次方程无合适解时退化为线性插值 */
+	static float GetCrossingOffset(float Prev, float Cur, float Next, float Threshold);
+
+	/* 帧加偏移转换为时间，超出动画范围时按循环折回 */
+	static float GetTime(const FFootTrajectory& Trajectory, int32 Frame, float Offset);
+};
+
+// 落地检测器：只读取预采样的轨迹，不会重新采样动画
+class IContactDetector
+{
+public:
+	virtual ~IContactDetector() {}
+
+	virtual FName GetName() const = 0;
+
+	/* 检测一只脚的落地与离地时间，不支持离地检测的检测器只输出落地时间 */
+	virtual void Detect(const FFootTrajectory& Trajectory, int32 Foot, const FContactDetectorSettings& Settings, FContactDetection& OutDetection) const = 0;
+
+	/* 所有注册的检测器，第一个为默认检测器 */
+	static const TArray<TSharedRef<IContactDetector>>& GetDetectors();
+	static const IContactDetector* FindDetector(FName Name);
+
+	/* 在同一份轨迹上运行多个检测器，结果为OutDetections[DetectorIndex * NumFeet + Foot] */
+	static void DetectAll(const FFootTrajectory& Trajectory, TArrayView<const IContactDetector* const> Detectors, const FContactDetectorSettings& Settings, TArray<FContactDetection>& OutDetections);
+
+	/* 根据方向标签取移动方向上的坐标，左右移动为X，前后移动为Y */
+	static float GetMoveAxisValue(const FVector& Location, Direction Dir);
+};
+
+// 移动方向上的转折点为落地，反方向的转折点为离地
+class FTurningContactDetector : public IContactDetector
+{
+public:
+	virtual FName GetName() const override { return FName("Turning"); }
+	virtual void Detect(const FFootTrajectory& Trajectory, int32 Foot, const FContactDetectorSettings& Settings, FContactDetection& OutDetection) const override;
+
+	/* 根据动画方向标签，判断本帧是否为改变方向的点，bIsLiftOff为true时判断反方向的转折点 */
+	static bool IsTurningPoint(FVector Last, FVector Cur, FVector Next, Direction Dir, bool bIsLiftOff = false);
+
+private:
+	/* 只检测转折点位于[Begin, End)的事件，寻找稳定低点时可以读到范围之后（循环折回）的帧，
+	   因此相邻的块不需要交换状态，边界上的转折点只属于一个块 */
+	static void DetectRange(const FFootTrajectory& Trajectory, int32 Foot, const FContactDetectorSettings& Settings, int32 Begin, int32 End, FContactDetection& OutDetection);
+};
+
+// 高度低于最低点加容差的区间，且区间内累积位移与移动方向相反时为一次落地
+class FHeightContactDetector : public IContactDetector
+{
+public:
+	virtual FName GetName() const override { return FName("Height"); }
+	virtual void Detect(const FFootTrajectory& Trajectory, int32 Foot, const FContactDetectorSettings& Settings, FContactDetection& OutDetection) const override;
+
+	/* 根据动画方向标签，判断累积位移的方向是否正确 */
+	static bool IsCumulativeDistanceValid(float Distance, Direction Dir);
+};
+
+// 单次线性遍历：由有限差分的相对根骨骼速度与高度判断站立，进入与离开使用不同阈值避免抖动
+// 站立时脚部相对根骨骼以接近恒定的速度向后移动，因此以最低点处的速度为站立参考速度
+// 从最高点（一定处于摆动中）开始循环遍历，站立区间不会被循环点切开
+class FVelocityContactDetector : public IContactDetector
+{
+public:
+	virtual FName GetName() const override { return FName("Velocity"); }
+	virtual void Detect(const FFootTrajectory& Trajectory, int32 Foot, const FContactDetectorSettings& Settings, FContactDetection& OutDetection) const override;
+};
+
+// 脚部骨骼在移动方向上越过根骨骼的时刻
+class FCrossingContactDetector : public IContactDetector
+{
+public:
+	virtual FName GetName() const override { return FName("Crossing"); }
+	virtual void Detect(const FFootTrajectory& Trajectory, int32 Foot, const FContactDetectorSettings& Settings, FContactDetection& OutDetection) const override;
+
+	/* 根据当前帧与上一帧的位置，判断当前帧是否为脚部骨骼越过根骨骼的时刻 */
+	static bool IsCrossingPoint(const FVector& Cur, const FVector& Last, Direction Dir);
+};
@@ -0,0 +1,153 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Curves/RichCurve.h"
+
+class UAnimSequence;
+class UPackage;
+
+// 烘焙的变换通道
+enum class ECurveBakeChannel : uint8
+{
+	Translation,
+	Rotation,
+	Scale
+};
+
+// 单条需要烘焙的曲线：骨骼，通道与轴
+struct FCurveBakeRequest
+{
+	FName BoneName;
+	ECurveBakeChannel Channel = ECurveBakeChannel::Translation;
+	int32 Axis = 0;
+
+	/* 输出的曲线名称，例如 foot_l_TranslationX */
+	FName GetCurveName() const;
+	static FString GetChannelName(ECurveBakeChannel Channel);
+};
+
+// 一次烘焙的设置，对一组动画共用
+struct FCurveBakeSettings
+{
+	TArray<FCurveBakeRequest> Requests;
+
+	// true时输出相对根骨骼的变换（根骨骼位移归零，与步态分析一致），否则为骨骼的局部变换
+	bool bRootRelative = false;
+	float TranslationScale = 1.f;
+	float RotationScale = 1.f;
+
+	// 关键帧精简的最大误差，为0时每帧一个关键帧
+	float KeyTolerance = 0.f;
+
+	// 帧数超过该值的动画按帧分块并行采样，为0时不分块
+	int32 ChunkFrames = 0;
+};
+
+// 单个动画的采样结果，所有曲线平铺在一个数组中：Values[Curve * NumFrames + Frame]
+struct FCurveBakeResult
+{
+	UAnimSequence * AnimSequence = nullptr;
+	int32 NumFrames = 0;
+	TArray<float> Times;
+	TArray<float> Values;
+	// 与Values中的曲线一一对应，找不到的骨骼不会输出曲线
+	TArray<FName> CurveNames;
+	bool bIsValid = false;
+
+	const float* GetCurveValues(int32 CurveIndex) const { return Values.GetData() + CurveIndex * NumFrames; }
+};
+
+// 写入动画序列或曲线资源的一条曲线
+struct FBakedCurve
+{
+	FName Name;
+	TArray<FRichCurveKey> Keys;
+
+	// 精简前的采样数量，用于统计压缩比
+	int32 NumSamples = 0;
+};
+
+// 一个动画需要写入的所有曲线
+struct FBakedAnimCurves
+{
+	UAnimSequence * AnimSequence = nullptr;
+	TArray<FBakedCurve> Curves;
+};
+
+// 骨骼链采样器：预先整理需要采样的骨骼与父子关系，之后可以按任意帧采样
+// 结果直接写入FCurveBakeResult的对应帧，未采样的帧保持未初始化
+class FBoneChainSampler
+{
+public:
+	/* 为所有帧分配结果并写入时间，找不到的骨骼不会输出曲线 */
+	bool Initialize(UAnimSequence* InAnimSequence, const FCurveBakeSettings& InSettings, FCurveBakeResult& OutResult);
+
+	/* 采样一帧，每个骨骼只计算一次，所有曲线共用 */
+	void SampleFrame(int32 Frame);
+
+	/* 采样[Begin, End)帧，只输出相对根骨骼的位移时每次4帧一起组合骨骼链，否则逐帧采样 */
+	void SampleFrames(int32 Begin, int32 End);
+
+	/* 骨骼链组合内核：Lanes为每个骨骼NumComponents个分量、每个分量4帧的SoA缓冲，父骨骼在子骨骼之前，
+	   原地将局部变换组合为相对链根的变换；bPositionsOnly的骨骼只计算位移 */
+	static void ComposeChainLanes(float* Lanes, const int32* ParentSlots, const bool* PositionsOnly, int32 NumBones);
+
+	// 每个骨骼的SoA分量：旋转XYZW，位移XYZ，缩放XYZ
+	static constexpr int32 NumComponents = 10;
+	static constexpr int32 NumLanes = 4;
+
+	/* 每帧需要组合的骨骼数量，用于估计采样开销 */
+	int32 GetNumBones() const { return BoneIndices.Num(); }
+
+private:
+	/* 一个骨骼在某一时间的局部变换，根骨骼在相对根骨骼空间下位移归零 */
+	FTransform GetLocalTransform(int32 Slot, float Time) const;
+
+	UAnimSequence * AnimSequence = nullptr;
+	const FCurveBakeSettings * Settings = nullptr;
+	FCurveBakeResult * Result = nullptr;
+	const FReferenceSkeleton * RefSkeleton = nullptr;
+
+	TArray<int32> BoneIndices;
+	TArray<int32> ParentSlots;
+	TArray<int32> TrackIndices;
+	TArray<int32> CurveSlots;
+	TArray<const FCurveBakeRequest*> ValidRequests;
+	TArray<FTransform> Transforms;
+
+	// 所有曲线都是相对根骨骼的位移时，可以按4帧一组批量组合骨骼链
+	bool bPositionsOnly = false;
+	// 没有子骨骼需要其旋转与缩放的骨骼
+	TArray<bool> SlotPositionsOnly;
+	TArray<float> Lanes;
+};
+
+// 批量曲线烘焙：一次遍历所有帧，同时采样所有需要的骨骼与通道，按动画并行
+class FCurveBaker
+{
+public:
+	/* 采样单个动画（可在工作线程上执行），长动画按ChunkFrames分块并行，每块使用采样器的副本 */
+	static bool SampleSequence(UAnimSequence* AnimSequence, const FCurveBakeSettings& Settings, FCurveBakeResult& OutResult);
+
+	/* 并行采样一组动画，按开销调度，长动画拆成帧段与其它动画一起分配 */
+	static void SampleSequences(const TArray<UAnimSequence*>& AnimSequences, const FCurveBakeSettings& Settings, TArray<FCurveBakeResult>& OutResults);
+
+	/* 将采样缓冲转为线性关键帧，线性时间的误差限精简：
+	   从上一个关键帧出发维护一个斜率区间，使直线与之后每个采样的误差都不超过Tolerance，
+	   区间为空时在上一个采样处结束当前线段，每个采样只访问一次 */
+	static void MakeCurveKeys(const float* Times, const float* Values, int32 NumSamples, float Tolerance, TArray<FRichCurveKey>& OutKeys);
+
+	/* 将采样结果转为可写入的曲线列表 */
+	static void MakeBakedCurves(const FCurveBakeResult& Result, float Tolerance, TArray<FBakedCurve>& OutCurves);
+
+	/* 输出精简前后的采样与关键帧数量以及压缩比 */
+	static void LogCompression(const TArray<FBakedAnimCurves>& BakedAnims);
+
+	/* 游戏线程：将曲线写入动画序列，同名曲线会被覆盖，所有曲线写完后只刷新一次 */
+	static bool WriteAnimationCurves(UAnimSequence* AnimSequence, const TArray<FBakedCurve>& Curves);
+
+	/* 游戏线程：将一个动画的所有曲线写入同一个曲线表资源，返回需要保存的包 */
+	static UPackage* WriteCurveTableAsset(UAnimSequence* AnimSequence, const TArray<FBakedCurve>& Curves, const FString& SavePath);
+};
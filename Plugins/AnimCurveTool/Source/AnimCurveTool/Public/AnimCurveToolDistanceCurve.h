@@ -0,0 +1,36 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UAnimSequence;
+struct FCurveBakeResult;
+
+// 根据根骨骼运动判断的动画类型，决定距离曲线的零点
+enum class EDistanceClipType : uint8
+{
+	// 循环或匀速移动：从动画开始的累积距离
+	Cycle,
+	// 起步：从动画开始的累积距离，为正
+	Start,
+	// 停步：到停止点的距离，为负并在停止时到达0
+	Stop,
+	// 转身：到转身点的距离，转身前为负，转身后为正
+	Pivot
+};
+
+// 距离匹配曲线：一次遍历根骨骼轨道得到水平面上的累积距离
+class FDistanceCurveBaker
+{
+public:
+	static const FName DistanceCurveName;
+
+	/* 生成单个动画的距离曲线，可在工作线程上执行，StopSpeedRatio为相对最大速度的静止阈值 */
+	static bool MakeDistanceCurve(UAnimSequence* AnimSequence, float StopSpeedRatio, FCurveBakeResult& OutResult, EDistanceClipType& OutClipType);
+
+	/* 根据逐帧的累积距离与水平位置判断动画类型，转身动画同时返回转身帧 */
+	static EDistanceClipType ClassifyClip(const TArray<float>& Distances, const TArray<FVector2D>& Positions, const TArray<float>& Times, float StopSpeedRatio, int32& OutPivotFrame);
+
+	static FString GetClipTypeName(EDistanceClipType ClipType);
+};
@@ -0,0 +1,152 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/SecureHash.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+class UAnimSequence;
+class SGMarkerReference;
+struct FContactDetectorSettings;
+struct FFootTrajectory;
+
+// 步态缓存文件：文件头，按路径哈希排序的索引，之后为字符串、基准点、基准区间与量化轨迹四段连续数据
+// 所有结构均为定长POD，按8字节对齐，映射文件后直接指向其中的数据，不需要解析
+struct FGaitCacheHeader
+{
+	uint32 Magic;
+	uint32 Version;
+	uint32 NumEntries;
+	uint32 Reserved;
+	uint64 IndexOffset;
+	uint64 StringOffset;
+	uint64 MarkerOffset;
+	uint64 IntervalOffset;
+	uint64 TrajectoryOffset;
+	uint64 FileSize;
+};
+
+struct FGaitCacheIndexEntry
+{
+	uint64 PathHash;
+	// 动画内容、方向与分析设置的哈希，用于找出内容相同的动画
+	uint64 DataHash;
+	// 原始数据GUID、帧数、长度与脚部骨骼的哈希，查找时不需要读取轨道数据，分析设置改变后轨迹仍可使用
+	uint64 IdentityHash;
+	// 脚部骨骼、检测器与分析设置的哈希，与动画标识一起校验缓存项
+	uint64 SettingsHash;
+	int64 AnalysisTicks;
+	// 字符串段中的UTF-8资源路径与检测器名称
+	uint32 PathOffset;
+	uint32 PathLength;
+	uint32 DetectorOffset;
+	uint32 DetectorLength;
+	// 基准点段中依次存放左脚基准点，右脚基准点，左脚离地点，右脚离地点
+	uint32 MarkerOffset;
+	uint32 NumMarkers[4];
+	uint32 IntervalOffset;
+	uint32 NumIntervals;
+	// 轨迹段中的字节偏移：每条曲线的最小值与步长，之后为16位量化值，没有轨迹时曲线数量为0
+	uint32 TrajectoryOffset;
+	uint32 TrajectoryNumFrames;
+	uint32 TrajectoryNumCurves;
+	float Tolerance;
+	uint8 Dir;
+	uint8 bIsValid;
+	uint8 bUsedFallback;
+	uint8 Pad;
+};
+
+struct FGaitCacheInterval
+{
+	float Left;
+	float Right;
+	uint8 bOrderIsLeftRight;
+	uint8 bIsWrapped;
+	uint8 Pad[2];
+};
+
+// 文件布局依赖以下大小，修改结构时需要同时提升FGaitCache::Version
+static_assert(sizeof(FGaitCacheHeader) == 64, "FGaitCacheHeader layout changed");
+static_assert(sizeof(FGaitCacheIndexEntry) == 104, "FGaitCacheIndexEntry layout changed");
+static_assert(sizeof(FGaitCacheInterval) == 12, "FGaitCacheInterval layout changed");
+
+// 一个缓存项在映射内存中的视图，缓存关闭后失效
+struct FGaitCacheEntryView
+{
+	TArrayView<const float> LeftMarkers;
+	TArrayView<const float> RightMarkers;
+	TArrayView<const float> LeftLiftOffs;
+	TArrayView<const float> RightLiftOffs;
+	TArrayView<const FGaitCacheInterval> Intervals;
+	const FGaitCacheIndexEntry * Entry = nullptr;
+	// 字符串段中的UTF-8字符，不以0结尾
+	const ANSICHAR * PathChars = nullptr;
+	const ANSICHAR * DetectorChars = nullptr;
+
+	FString GetPath() const;
+	FName GetDetectorName() const;
+};
+
+// 持久化的步态分析结果，文件映射后按路径哈希二分查找
+class FGaitCache
+{
+public:
+	FGaitCache();
+	~FGaitCache();
+
+	static constexpr uint32 Magic = 0x46434741; // 'AGCF'
+	static constexpr uint32 Version = 3;
+
+	/* Saved/AnimCurveTool/GaitCache.bin */
+	static FString GetDefaultFilename();
+
+	/* 映射缓存文件，不支持映射的平台读入内存，文件不存在或版本不符时返回false */
+	bool Open(const FString& InFilename);
+	void Close();
+	bool IsOpen() const { return Header != nullptr; }
+	int32 Num() const { return Index.Num(); }
+
+	/* 路径、动画标识与设置哈希都一致时返回缓存项的视图，不需要计算内容哈希 */
+	bool Find(const FString& AssetPath, uint64 IdentityHash, uint64 SettingsHash, FGaitCacheEntryView& OutView) const;
+
+	/* 路径与动画标识一致且保存了轨迹时，还原为完整的脚部轨迹 */
+	bool FindTrajectory(UAnimSequence* AnimSequence, const TArray<FName>& BoneNames, FFootTrajectory& OutTrajectory) const;
+
+	/* 将当前缓存中的项与新的结果合并后写回文件，同一路径以新的结果为准，之后重新映射
+	   轨迹缓存中有对应的全帧率轨迹时一并写入 */
+	bool Save(const TArray<const SGMarkerReference*>& References, const TArray<FName>& BoneNames);
+
+	/* 动画内容的SHA1：帧数，长度，以及骨骼链上每个骨骼的名称、参考姿势与原始轨道数据，
+	   不同路径下内容完全相同的动画得到相同的哈希 */
+	static FSHAHash MakeContentHash(UAnimSequence* AnimSequence, const TArray<FName>& BoneNames);
+
+	/* 影响分析结果的脚部骨骼、检测器与设置的哈希，0保留为“不缓存” */
+	static uint64 MakeSettingsHash(FName LeftFoot, FName RightFoot, FName DetectorName, const FContactDetectorSettings& Settings);
+
+	/* 动画内容、方向标签与分析设置的哈希，相同时分析结果相同 */
+	static uint64 MakeDataHash(const FSHAHash& ContentHash, uint8 Dir, uint64 SettingsHash);
+	static uint64 MakePathHash(const FString& AssetPath);
+
+	/* 不读取轨道数据的廉价标识：原始数据GUID、帧数、长度与骨骼 */
+	static uint64 MakeIdentityHash(UAnimSequence* AnimSequence, const TArray<FName>& BoneNames);
+
+private:
+	/* 按路径查找缓存项，损坏的缓存项视为不存在 */
+	const FGaitCacheIndexEntry* FindEntry(const FString& AssetPath) const;
+
+	/* 缓存项引用的字符串、基准点与基准区间是否都在各自的段内，损坏的缓存项不会被读取 */
+	bool IsEntryInBounds(const FGaitCacheIndexEntry& Entry) const;
+	FGaitCacheEntryView MakeView(const FGaitCacheIndexEntry& Entry) const;
+
+	FString Filename;
+	IMappedFileHandle * MappedFile = nullptr;
+	IMappedFileRegion * MappedRegion = nullptr;
+	TArray<uint8> LoadedData;
+
+	const uint8 * Data = nullptr;
+	const FGaitCacheHeader * Header = nullptr;
+	TArrayView<const FGaitCacheIndexEntry> Index;
+};
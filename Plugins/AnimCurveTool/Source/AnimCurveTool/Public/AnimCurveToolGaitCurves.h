@@ -0,0 +1,61 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class SGMarkerReference;
+struct FCurveBakeResult;
+struct FBakedCurve;
+struct FGaitTableInterval;
+
+// 步态相位的归一化方式
+enum class EGaitPhaseMode : uint8
+{
+	// 一个完整步幅为0-1，左脚落地为0，右脚落地为0.5
+	Stride,
+	// 每个半步（左-右或右-左区间）各为0-1
+	HalfCycle
+};
+
+// 由步态分析结果生成曲线的设置
+struct FGaitCurveSettings
+{
+	// 接触曲线在落地前与离地后的过渡时间
+	float ContactBlendTime = 0.1f;
+	// 锁脚曲线在落地后与离地前的过渡时间
+	float LockBlendTime = 0.1f;
+};
+
+// 根据同步组中缓存的步态分析结果生成曲线，不需要重新采样骨骼
+class FGaitCurveBaker
+{
+public:
+	static const FName LeftContactCurveName;
+	static const FName RightContactCurveName;
+	static const FName LeftLockCurveName;
+	static const FName RightLockCurveName;
+	static const FName PhaseCurveName;
+
+	// 相位回到0时，前一段末尾关键帧提前的时间，避免同一时刻有两个关键帧
+	static constexpr float PhaseWrapGap = 0.001f;
+
+	/* 生成左右脚的接触曲线(0/1)与锁脚权重曲线，按帧写入Result，可在工作线程上执行 */
+	static bool MakeFootCurves(const SGMarkerReference& Reference, const FGaitCurveSettings& Settings, FCurveBakeResult& OutResult);
+
+	/* 由基准区间直接生成相位曲线，每个区间内相位为线性，关键帧只在区间边界上，不需要逐帧采样与精简 */
+	static bool MakePhaseCurve(const SGMarkerReference& Reference, EGaitPhaseMode Mode, FBakedCurve& OutCurve);
+
+	/* 转换为运行时步态表的区间，跨越循环的区间右界加上循环长度，并计算区间内根骨骼的水平速度 */
+	static void MakeGaitTableIntervals(const SGMarkerReference& Reference, TArray<FGaitTableInterval>& OutIntervals);
+
+	/* 每次落地到之后最近一次离地为一个站立区间，跨越循环的区间右界加上循环长度 */
+	static void GetStanceIntervals(const TArray<float>& Contacts, const TArray<float>& LiftOffs, float Length, TArray<FVector2D>& OutStances);
+
+	/* 梯形权重：[Start, End]内为1，两侧Ramp内线性过渡到0 */
+	static float GetTrapezoidWeight(float Time, float Start, float End, float Ramp);
+
+protected:
+	/* 在一组站立区间上按帧计算权重，bInside为true时过渡在区间内部（锁脚），否则在区间外部（接触） */
+	static void SampleStanceWeights(const TArray<FVector2D>& Stances, float Ramp, bool bInside, float Length, const TArray<float>& Times, float* OutValues);
+};
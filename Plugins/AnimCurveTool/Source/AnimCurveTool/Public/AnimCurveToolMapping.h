@@ -0,0 +1,50 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class SGMarkerReference;
+
+// 一组目标动画的基准区间，按左-右/右-左顺序拆成两张表，每张表为连续存放的SoA数组
+// 跨越循环的区间预先把动画长度加进Span，映射时不需要区分是否跨越循环
+struct FGaitIntervalTable
+{
+	struct FOrderTable
+	{
+		// 区间左界、区间长度与所属动画的长度，长度补齐到4的倍数，补齐部分为0
+		TArray<float> Left;
+		TArray<float> Span;
+		TArray<float> Length;
+
+		// 第k个目标的区间位于[TargetOffsets[k], TargetOffsets[k+1])
+		TArray<int32> TargetOffsets;
+
+		// 不含补齐部分的区间数量
+		int32 NumIntervals = 0;
+
+		int32 NumPadded() const { return Left.Num(); }
+		int32 GetTargetStart(int32 TargetIndex) const { return TargetOffsets[TargetIndex]; }
+		int32 GetTargetCount(int32 TargetIndex) const { return TargetOffsets[TargetIndex + 1] - TargetOffsets[TargetIndex]; }
+	};
+
+	// 0：右-左区间，1：左-右区间
+	FOrderTable Tables[2];
+	int32 NumTargets = 0;
+
+	void Build(const TArray<const SGMarkerReference*>& Targets);
+
+	const FOrderTable& GetTable(bool bOrderIsLeftRight) const { return Tables[bOrderIsLeftRight ? 1 : 0]; }
+};
+
+// 批量的比例-时间映射：一次处理所有目标的所有同向区间
+class FBatchedRatioMapper
+{
+public:
+	/* 为每个比例在对应顺序的表上计算全部目标时间，结果写入预分配的平铺缓冲
+	   第e个比例的结果从OutEventOffsets[e]开始，长度为对应表的NumPadded() */
+	static void MapRatios(const FGaitIntervalTable& Table, TArrayView<const float> Ratios, TArrayView<const bool> Orders, TArray<float>& OutTimes, TArray<int32>& OutEventOffsets);
+
+	/* 映射内核：Out[i] = Left[i] + Span[i] * Ratio，超过动画长度时减去长度，4路SIMD，无分支 */
+	static void MapRatio(const FGaitIntervalTable::FOrderTable& Table, float Ratio, float* Out);
+};
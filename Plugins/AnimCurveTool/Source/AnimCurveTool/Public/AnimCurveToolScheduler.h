@@ -0,0 +1,36 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UAnimSequence;
+
+// 批处理中的一个任务：第Item个动画的[FrameBegin, FrameEnd)帧
+struct FBatchJob
+{
+	int32 Item = 0;
+	int32 FrameBegin = 0;
+	int32 FrameEnd = 0;
+	int64 Cost = 0;
+};
+
+// 按开销调度的批处理：长度差别很大的动画混在一起时，按开销从大到小排序，
+// 工作线程从共享的计数器依次领取任务，先做完的线程自动接手剩余任务，过大的动画拆成多个帧段
+class FBatchScheduler
+{
+public:
+	/* 估计一个动画的开销：帧数 × 采样这些骨骼需要组合的骨骼链长度 */
+	static int64 EstimateCost(UAnimSequence* AnimSequence, const TArray<FName>& BoneNames, bool bRootRelative);
+
+	/* 为每个项目生成任务，bSplittable时开销超过份额的项目按帧拆分，结果按开销从大到小排序 */
+	static void MakeJobs(TArrayView<const int64> Costs, TArrayView<const int32> NumFrames, bool bSplittable, TArray<FBatchJob>& OutJobs);
+
+	/* 在所有工作线程上执行任务，Work可能在任意线程上并发调用 */
+	static void Run(const TArray<FBatchJob>& Jobs, TFunctionRef<void(const FBatchJob&)> Work);
+
+	static int32 GetNumWorkers();
+
+	// 拆分后每个帧段的最少帧数，避免任务过碎
+	static constexpr int32 MinSplitFrames = 64;
+};
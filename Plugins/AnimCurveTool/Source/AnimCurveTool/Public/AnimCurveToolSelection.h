@@ -0,0 +1,60 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Internationalization/Regex.h"
+
+class UAnimSequence;
+
+// 保持加入顺序的动画集合，数组用于顺序遍历与列表显示，哈希集合用于O(1)去重
+class FAnimSelection
+{
+public:
+	/* 加入动画，已存在时返回false */
+	bool Add(UAnimSequence* AnimSequence);
+	bool Contains(UAnimSequence* AnimSequence) const { return Lookup.Contains(AnimSequence); }
+	void Reset();
+	void Reserve(int32 Number);
+
+	int32 Num() const { return Items.Num(); }
+	const TArray<UAnimSequence*>& GetArray() const { return Items; }
+
+	TArray<UAnimSequence*>::RangedForConstIteratorType begin() const { return Items.begin(); }
+	TArray<UAnimSequence*>::RangedForConstIteratorType end() const { return Items.end(); }
+
+private:
+	TArray<UAnimSequence*> Items;
+	TSet<UAnimSequence*> Lookup;
+};
+
+// 单条名称规则，通配符或正则表达式，在提交时编译
+struct FAnimNameRule
+{
+	bool bInclude = true;
+	bool bIsRegex = false;
+	FString Pattern;
+	TSharedPtr<FRegexPattern> Regex;
+
+	bool Matches(const FString& AnimName) const;
+};
+
+// 编译后的动画名称筛选器，前后缀与规则只在文本提交时解析一次，之后对每个动画复用
+// 规则以';'分隔，'-'开头为排除规则，'+'或无前缀为包含规则，"re:"开头为正则表达式，否则为*?通配符
+// 例如："Walk_*;Run_*;-*_Additive;re:^Sprint_[FB]$"
+class FAnimNameFilter
+{
+public:
+	void Compile(const FString& InPrefix, const FString& InPostfix, const FString& InRules);
+
+	/* 名称需满足前后缀，命中任意包含规则（没有包含规则时视为命中），且不命中任何排除规则 */
+	bool PassesFilter(const FString& AnimName) const;
+
+	bool IsEmpty() const { return Prefix.Len() == 0 && Postfix.Len() == 0 && IncludeRules.Num() == 0 && ExcludeRules.Num() == 0; }
+
+private:
+	FString Prefix;
+	FString Postfix;
+	TArray<FAnimNameRule> IncludeRules;
+	TArray<FAnimNameRule> ExcludeRules;
+};
@@ -0,0 +1,70 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/SubclassOf.h"
+#include "AnimCurveToolMapping.h"
+
+class UAnimSequence;
+class UAnimNotify;
+class SGMarkerReference;
+
+// 参考动画轨道上的一个事件（同步标记或动画通知），已换算为基准区间上的比例
+struct FSyncSourceEvent
+{
+	FName TrackName;
+	float RefRatio = 0.f;
+	bool bOrderIsLeftRight = true;
+	bool bIsNotify = false;
+	FName MarkerName;
+	TSubclassOf<UAnimNotify> NotifyClass;
+};
+
+// 规划出的一个目标事件
+struct FSyncPlannedEvent
+{
+	FName TrackName;
+	float Time = 0.f;
+	// 指向FSyncSourceEvent，用于在应用阶段取得标记名与通知类型
+	int32 SourceIndex = INDEX_NONE;
+};
+
+// 单个目标动画的最终同步结果，在工作线程上计算，在游戏线程上一次性应用
+struct FSyncTargetPlan
+{
+	UAnimSequence * AnimSequence = nullptr;
+	TArray<FSyncPlannedEvent> Markers;
+	TArray<FSyncPlannedEvent> Notifies;
+};
+
+// 同步任务中的一项：从某个参考动画的某条轨道复制事件
+struct FSyncJobSource
+{
+	UAnimSequence * RefAnimSequence = nullptr;
+	FName TrackName;
+
+	bool operator==(const FSyncJobSource& Other) const
+	{
+		return RefAnimSequence == Other.RefAnimSequence && TrackName == Other.TrackName;
+	}
+};
+
+// 同步组的两阶段同步：规划阶段为纯计算，可并行；应用阶段修改资源，必须在游戏线程
+class FReferenceGroupSync
+{
+public:
+	/* 收集参考动画指定轨道上的同步标记与通知，并换算为参考区间比例（游戏线程） */
+	static bool CollectEvents(const SGMarkerReference& Reference, FName TrackName, TArray<FSyncSourceEvent>& OutEvents);
+
+	/* 为所有目标计算最终的标记与通知列表：先用批量映射内核一次算出所有目标时间，
+	   再按目标并行去重，每个目标相互独立 */
+	static void PlanTargets(const TArray<FSyncSourceEvent>& Events, const TArray<const SGMarkerReference*>& Targets, TArray<FSyncTargetPlan>& OutPlans);
+
+	/* 单个目标的规划，从映射结果中取出该目标的时间，同一轨道上相近时间的重复事件会被跳过 */
+	static void PlanTarget(const TArray<FSyncSourceEvent>& Events, const FGaitIntervalTable& Table, int32 TargetIndex,
+		const TArray<float>& MappedTimes, const TArray<int32>& EventOffsets, FSyncTargetPlan& OutPlan);
+
+	// 判定两个事件时间重复的阈值
+	static constexpr float DuplicateTolerance = 0.01f;
+};
@@ -0,0 +1,83 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/List.h"
+#include "Stats/Stats.h"
+
+struct FFootTrajectory;
+class UAnimSequence;
+
+DECLARE_STATS_GROUP(TEXT("AnimCurveTool"), STATGROUP_AnimCurveTool, STATCAT_Advanced);
+
+// 量化的脚部轨迹：只保存检测器需要的相对根骨骼位移，每条曲线按本动画的范围量化为16位
+struct FQuantizedTrajectory
+{
+	TArray<FName> BoneNames;
+	TArray<FName> CurveNames;
+	int32 NumFrames = 0;
+	// 每条曲线的最小值与量化步长，还原值为 Min + Q * Step
+	TArray<float> Mins;
+	TArray<float> Steps;
+	// Q[Curve * NumFrames + Frame]
+	TArray<uint16> Values;
+	// 量化时实测的最大还原误差，不超过最大步长的一半
+	float MaxError = 0.f;
+
+	void Quantize(const FFootTrajectory& Trajectory);
+	void Dequantize(UAnimSequence* AnimSequence, FFootTrajectory& OutTrajectory) const;
+
+	/* 理论误差上界：最大步长的一半 */
+	float GetErrorBound() const;
+	SIZE_T GetAllocatedSize() const;
+};
+
+// 按内存预算淘汰最久未使用项的轨迹缓存，所有线程共用
+class FTrajectoryCache
+{
+public:
+	static FTrajectoryCache& Get();
+
+	/* 找到时还原为完整轨迹并标记为最近使用 */
+	bool Find(UAnimSequence* AnimSequence, const TArray<FName>& BoneNames, FFootTrajectory& OutTrajectory);
+
+	/* 复制量化的轨迹，用于写入步态缓存，不计入命中率 */
+	bool FindQuantized(UAnimSequence* AnimSequence, const TArray<FName>& BoneNames, FQuantizedTrajectory& OutTrajectory);
+
+	/* 量化并加入缓存，超出预算时淘汰最久未使用的轨迹 */
+	void Add(const FFootTrajectory& Trajectory);
+
+	void SetBudget(int64 InBudgetBytes);
+	int64 GetBudget() const { return BudgetBytes; }
+	void Empty();
+
+	/* 输出命中率、淘汰次数、内存占用与量化误差 */
+	void LogStats();
+
+private:
+	/* 动画路径、原始数据GUID、帧数、长度与骨骼组成的键，重新导入或编辑后旧的轨迹不会再被命中，最终被淘汰 */
+	static FString MakeKey(UAnimSequence* AnimSequence, const TArray<FName>& BoneNames);
+
+	void EvictToBudget();
+
+	struct FEntry
+	{
+		FQuantizedTrajectory Trajectory;
+		SIZE_T Size = 0;
+		TDoubleLinkedList<FString>::TDoubleLinkedListNode * Node = nullptr;
+	};
+
+	FCriticalSection Lock;
+	TMap<FString, FEntry> Entries;
+	// 头部为最近使用
+	TDoubleLinkedList<FString> UsageList;
+	int64 BudgetBytes = 256ll * 1024 * 1024;
+	int64 UsedBytes = 0;
+
+	int64 NumHits = 0;
+	int64 NumMisses = 0;
+	int64 NumEvictions = 0;
+	float MaxErrorSeen = 0.f;
+	float MaxErrorBoundSeen = 0.f;
+};
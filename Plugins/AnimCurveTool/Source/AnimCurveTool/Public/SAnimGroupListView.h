@@ -0,0 +1,64 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SCompoundWidget.h"
+#include "Widgets/Views/SListView.h"
+#include "Widgets/Views/STableRow.h"
+
+class UAnimSequence;
+class SGMarkerReference;
+
+// 列表中的一行，缓存该行显示用的状态，只在对应动画的分析结果变化时更新
+struct FAnimGroupListItem
+{
+	UAnimSequence * AnimSequence = nullptr;
+	FText Name;
+	FText Direction;
+	FText MarkerCount;
+	FText AnalysisTime;
+};
+
+typedef TSharedPtr<FAnimGroupListItem> FAnimGroupListItemPtr;
+
+// 查询动画的同步组预计算结果，没有结果时返回nullptr
+DECLARE_DELEGATE_RetVal_OneParam(const SGMarkerReference*, FOnGetAnimReference, UAnimSequence*);
+
+// 虚拟化的动画分组预览，只为可见的行生成控件，并支持增量更新
+class SAnimGroupListView : public SCompoundWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SAnimGroupListView)
+		: _Height(300.0f)
+	{}
+		SLATE_ARGUMENT(float, Height)
+		SLATE_EVENT(FOnGetAnimReference, OnGetReference)
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs);
+
+	/* 在列表末尾追加尚未显示的动画 */
+	void AddItems(const TArray<UAnimSequence*>& AnimSequences);
+
+	/* 将列表内容替换为输入的动画，已存在的行会被复用 */
+	void SetItems(const TArray<UAnimSequence*>& AnimSequences);
+
+	/* 清空列表 */
+	void ResetItems();
+
+	/* 重新读取某个动画的分析状态，行控件通过绑定自动刷新 */
+	void RefreshStatus(UAnimSequence* AnimSequence);
+	void RefreshAllStatus();
+
+private:
+	FAnimGroupListItemPtr MakeItem(UAnimSequence* AnimSequence);
+	void UpdateItemStatus(FAnimGroupListItem& Item) const;
+	TSharedRef<ITableRow> OnGenerateRow(FAnimGroupListItemPtr Item, const TSharedRef<STableViewBase>& OwnerTable);
+	FText GetNameColumnLabel() const;
+
+	TArray<FAnimGroupListItemPtr> Items;
+	TMap<UAnimSequence*, FAnimGroupListItemPtr> ItemMap;
+	TSharedPtr<SListView<FAnimGroupListItemPtr>> ListView;
+	FOnGetAnimReference OnGetReference;
+};
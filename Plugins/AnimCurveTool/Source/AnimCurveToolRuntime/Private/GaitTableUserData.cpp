@@ -0,0 +1,121 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GaitTableUserData.h"
+
+void UGaitTableUserData::Initialize(float InLength, const TArray<float>& InLeftContacts, const TArray<float>& InRightContacts, TArray<FGaitTableInterval> InIntervals)
+{
+	Length = InLength;
+	InvLength = InLength > 0.f ? 1.f / InLength : 0.f;
+	LeftContacts = InLeftContacts;
+	LeftContacts.Sort();
+	RightContacts = InRightContacts;
+	RightContacts.Sort();
+
+	InIntervals.Sort([](const FGaitTableInterval& A, const FGaitTableInterval& B) { return A.Start < B.Start; });
+	NumIntervals = Length > 0.f ? InIntervals.Num() : 0;
+
+	IntervalStart.Reset(NumIntervals);
+	IntervalEnd.Reset(NumIntervals);
+	IntervalInvSpan.Reset(NumIntervals);
+	IntervalPhaseStart.Reset(NumIntervals);
+	IntervalSpeed.Reset(NumIntervals);
+	BucketToInterval.Reset();
+	BucketScale = 0.f;
+
+	if (NumIntervals == 0)
+	{
+		return;
+	}
+
+	float MinSpan = Length;
+	for (const FGaitTableInterval & Interval : InIntervals)
+	{
+		const float Span = FMath::Max(Interval.End - Interval.Start, KINDA_SMALL_NUMBER);
+		IntervalStart.Add(Interval.Start);
+		IntervalEnd.Add(Interval.Start + Span);
+		IntervalInvSpan.Add(1.f / Span);
+		IntervalPhaseStart.Add(Interval.bOrderIsLeftRight ? 0.f : 0.5f);
+		IntervalSpeed.Add(Interval.Speed);
+		MinSpan = FMath::Min(MinSpan, Span);
+	}
+
+	// 桶宽不大于最短区间，每个桶内最多只有一个区间起点
+	const int32 NumBuckets = FMath::Clamp(FMath::CeilToInt(Length / MinSpan), 1, 1024);
+	BucketScale = NumBuckets * InvLength;
+	BucketToInterval.SetNumUninitialized(NumBuckets);
+	int32 Index = 0;
+	for (int32 Bucket = 0; Bucket < NumBuckets; Bucket++)
+	{
+		const float BucketStart = Bucket * Length / NumBuckets;
+		while (Index + 1 < NumIntervals && IntervalStart[Index + 1] <= BucketStart)
+		{
+			Index++;
+		}
+		BucketToInterval[Bucket] = Index;
+	}
+}
+
+int32 UGaitTableUserData::FindInterval(float Time, float& OutTime) const
+{
+	// 时间归一到[0, Length)
+	float LocalTime = Time - Length * FMath::FloorToFloat(Time * InvLength);
+	const int32 Bucket = FMath::Min((int32)(LocalTime * BucketScale), BucketToInterval.Num() - 1);
+	int32 Index = BucketToInterval[Bucket];
+	while (Index + 1 < NumIntervals && LocalTime >= IntervalStart[Index + 1])
+	{
+		Index++;
+	}
+
+	// 第一个区间起点之前的时间属于跨越循环的最后一个区间
+	const bool bBeforeFirst = LocalTime < IntervalStart[Index];
+	Index = bBeforeFirst ? NumIntervals - 1 : Index;
+	OutTime = bBeforeFirst ? LocalTime + Length : LocalTime;
+	return Index;
+}
+
+float UGaitTableUserData::GetPhase(float Time) const
+{
+	if (NumIntervals == 0)
+	{
+		return 0.f;
+	}
+
+	float LocalTime;
+	const int32 Index = FindInterval(Time, LocalTime);
+	return IntervalPhaseStart[Index] + 0.5f * FMath::Clamp((LocalTime - IntervalStart[Index]) * IntervalInvSpan[Index], 0.f, 1.f);
+}
+
+float UGaitTableUserData::GetTimeToNextContact(float Time, EGaitFoot& OutFoot) const
+{
+	OutFoot = EGaitFoot::Left;
+	if (NumIntervals == 0)
+	{
+		return 0.f;
+	}
+
+	// 区间的右界即下一次落地，左-右区间结束于右脚落地
+	float LocalTime;
+	const int32 Index = FindInterval(Time, LocalTime);
+	OutFoot = IntervalPhaseStart[Index] == 0.f ? EGaitFoot::Right : EGaitFoot::Left;
+	return FMath::Max(IntervalEnd[Index] - LocalTime, 0.f);
+}
+
+float UGaitTableUserData::GetStrideSpeed(float Time) const
+{
+	if (NumIntervals == 0)
+	{
+		return 0.f;
+	}
+
+	float LocalTime;
+	return IntervalSpeed[FindInterval(Time, LocalTime)];
+}
+
+void UGaitTableUserData::GetPhases(TArrayView<const float> Times, TArrayView<float> OutPhases) const
+{
+	check(Times.Num() == OutPhases.Num());
+	for (int32 i = 0; i < Times.Num(); i++)
+	{
+		OutPhases[i] = GetPhase(Times[i]);
+	}
+}
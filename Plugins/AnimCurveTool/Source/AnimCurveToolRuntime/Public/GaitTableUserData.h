@@ -0,0 +1,102 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/AssetUserData.h"
+#include "GaitTableUserData.generated.h"
+
+UENUM(BlueprintType)
+enum class EGaitFoot : uint8
+{
+	Left,
+	Right
+};
+
+// 编辑器烘焙时输入的一个基准区间，End可能超过动画长度（跨越循环）
+struct FGaitTableInterval
+{
+	float Start = 0.f;
+	float End = 0.f;
+	bool bOrderIsLeftRight = false;
+	// 区间内根骨骼的水平平均速度
+	float Speed = 0.f;
+};
+
+/**
+ * 由编辑器工具烘焙到动画序列上的步态表，运行时按时间查询相位、下一次落地与步幅速度
+ * 区间按起点排序并以SoA存放，查询通过定长的时间桶直接定位区间，不分配内存
+ */
+UCLASS(BlueprintType)
+class ANIMCURVETOOLRUNTIME_API UGaitTableUserData : public UAssetUserData
+{
+	GENERATED_BODY()
+
+public:
+	/* 编辑器调用：由步态分析结果重建所有表 */
+	void Initialize(float InLength, const TArray<float>& InLeftContacts, const TArray<float>& InRightContacts, TArray<FGaitTableInterval> InIntervals);
+
+	bool IsValid() const { return NumIntervals > 0; }
+
+	/* 步幅相位，左脚落地为0，右脚落地为0.5 */
+	UFUNCTION(BlueprintPure, Category = "Gait")
+	float GetPhase(float Time) const;
+
+	/* 到下一次落地的时间，以及落地的是哪只脚 */
+	UFUNCTION(BlueprintPure, Category = "Gait")
+	float GetTimeToNextContact(float Time, EGaitFoot& OutFoot) const;
+
+	/* 当前所在半步的根骨骼水平速度 */
+	UFUNCTION(BlueprintPure, Category = "Gait")
+	float GetStrideSpeed(float Time) const;
+
+	/* 批量查询相位，供同时评估大量角色的系统使用 */
+	void GetPhases(TArrayView<const float> Times, TArrayView<float> OutPhases) const;
+
+	/* 定位时间所在的区间，OutTime为展开到该区间时间轴上的时间（可能超过动画长度） */
+	int32 FindInterval(float Time, float& OutTime) const;
+
+	const TArray<float>& GetLeftContacts() const { return LeftContacts; }
+	const TArray<float>& GetRightContacts() const { return RightContacts; }
+
+protected:
+	UPROPERTY(VisibleAnywhere, Category = "Gait")
+	float Length = 0.f;
+
+	UPROPERTY()
+	float InvLength = 0.f;
+
+	UPROPERTY(VisibleAnywhere, Category = "Gait")
+	int32 NumIntervals = 0;
+
+	// 每只脚排序后的落地时间
+	UPROPERTY(VisibleAnywhere, Category = "Gait")
+	TArray<float> LeftContacts;
+
+	UPROPERTY(VisibleAnywhere, Category = "Gait")
+	TArray<float> RightContacts;
+
+	// 区间的SoA表，按起点排序
+	UPROPERTY(VisibleAnywhere, Category = "Gait")
+	TArray<float> IntervalStart;
+
+	UPROPERTY(VisibleAnywhere, Category = "Gait")
+	TArray<float> IntervalEnd;
+
+	UPROPERTY()
+	TArray<float> IntervalInvSpan;
+
+	// 区间起点的步幅相位，左-右区间为0，右-左区间为0.5
+	UPROPERTY()
+	TArray<float> IntervalPhaseStart;
+
+	UPROPERTY(VisibleAnywhere, Category = "Gait")
+	TArray<float> IntervalSpeed;
+
+	// 时间桶到桶起点所在区间的映射，桶宽不大于最短区间，定位后最多再前进一步
+	UPROPERTY()
+	TArray<int32> BucketToInterval;
+
+	UPROPERTY()
+	float BucketScale = 0.f;
+};